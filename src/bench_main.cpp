@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "levels.h"
+#include "process_stats.h"
+#include "solver.h"
+
+// Solver benchmark over a corpus of level files. The corpus index lists one
+// puzzle per line as "<group> <level file>", paths relative to the index:
+//   ParkingJamBench [--solvers bfs,parallel,ida,external] [--threads N] [--table-mb N]
+//                   [--scratch DIR] [--max-states N] [--max-expansions N]
+//                   [--repeat N] [--group NAME] [--json FILE] [corpus index]
+// Each solver runs every puzzle --repeat times and keeps its fastest run.
+// The default solvers are bfs and parallel: IDA* still gives up on the long
+// Rush Hour puzzles, so it only runs when asked for with --solvers.
+// Peak RSS is the process high-water mark after the run, so it only grows
+// over a session; run a single group or puzzle for a per-puzzle figure.
+
+struct BenchPuzzle {
+    std::string group;
+    std::string name;
+    std::string path;
+};
+
+struct BenchRun {
+    std::string solver;
+    bool ok = false;                 // false if the solver refused the board
+    SolveResult result;
+    size_t peakRssBytes = 0;
+};
+
+static bool readCorpus(const std::string& indexPath, const std::string& group, std::vector<BenchPuzzle>& puzzles) {
+    std::ifstream in(indexPath.c_str());
+    if (!in) {
+        std::cerr << "Bench: cannot open corpus index " << indexPath << std::endl;
+        return false;
+    }
+    size_t slash = indexPath.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? "" : indexPath.substr(0, slash + 1);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        BenchPuzzle puzzle;
+        std::istringstream fields(line);
+        if (!(fields >> puzzle.group >> puzzle.path)) continue;
+        if (!group.empty() && puzzle.group != group) continue;
+
+        size_t nameStart = puzzle.path.find_last_of("/\\");
+        puzzle.name = puzzle.path.substr(nameStart == std::string::npos ? 0 : nameStart + 1);
+        size_t dot = puzzle.name.rfind('.');
+        if (dot != std::string::npos) puzzle.name.erase(dot);
+        puzzle.path = directory + puzzle.path;
+        puzzles.push_back(puzzle);
+    }
+    return true;
+}
+
+static bool runSolver(const std::string& solver, const Board& board, const SolveOptions& options,
+                      SolveResult& result) {
+    if (solver == "bfs") return solveBfs(board, boardStartState(board), options, result);
+    if (solver == "parallel") return solveParallelBfs(board, boardStartState(board), options, result);
+    if (solver == "ida") return solveIdaStar(board, boardStartState(board), options, result);
+    if (solver == "external") return solveExternalBfs(board, boardStartState(board), options, result);
+    std::cerr << "Bench: unknown solver " << solver << std::endl;
+    return false;
+}
+
+static const char* runStatus(const BenchRun& run) {
+    if (!run.ok) return "error";
+    if (run.result.solved) return "solved";
+    return run.result.aborted ? "aborted" : "unsolvable";
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static bool writeJsonReport(const std::string& path, const std::string& indexPath, const SolveOptions& options,
+                            int repeat, const std::vector<BenchPuzzle>& puzzles,
+                            const std::vector<std::vector<BenchRun> >& runs, const std::vector<Board>& boards) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Bench: cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"corpus\": " << jsonString(indexPath) << ",\n";
+    out << "  \"threads\": " << options.threads << ",\n";
+    out << "  \"repeat\": " << repeat << ",\n";
+    out << "  \"puzzles\": [\n";
+    for (size_t p = 0; p < puzzles.size(); p++) {
+        out << "    {\"name\": " << jsonString(puzzles[p].name) << ", \"group\": " << jsonString(puzzles[p].group)
+            << ", \"cars\": " << boards[p].cars.size() << ", \"key_bits\": " << boards[p].keyBits << ",\n";
+        out << "     \"runs\": [\n";
+        for (size_t r = 0; r < runs[p].size(); r++) {
+            const BenchRun& run = runs[p][r];
+            const SolveStats& stats = run.result.stats;
+            out << "       {\"solver\": " << jsonString(run.solver) << ", \"status\": \"" << runStatus(run) << "\"";
+            if (run.result.solved) out << ", \"moves\": " << run.result.moves.size();
+            out << ", \"expanded\": " << stats.expanded << ", \"stored\": " << stats.stored
+                << ", \"seconds\": " << stats.seconds << ", \"nodes_per_second\": " << stats.statesPerSecond()
+                << ", \"table_bytes\": " << stats.tableBytes << ", \"peak_rss_bytes\": " << run.peakRssBytes << "}"
+                << (r + 1 < runs[p].size() ? "," : "") << "\n";
+        }
+        out << "     ]}" << (p + 1 < puzzles.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    out.close();
+    if (!out) {
+        std::cerr << "Bench: error writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    SolveOptions options;
+    options.maxExpansions = 5000000ULL;
+    size_t tableMegabytes = 64;
+    int repeat = 1;
+    std::string indexPath = "bench/corpus.txt";
+    std::string group;
+    const char* jsonPath = NULL;
+    std::vector<std::string> solvers = {"bfs", "parallel"};
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--solvers") == 0 && i + 1 < argc) {
+            solvers.clear();
+            std::istringstream list(argv[++i]);
+            std::string solver;
+            while (std::getline(list, solver, ',')) solvers.push_back(solver);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--table-mb") == 0 && i + 1 < argc) {
+            tableMegabytes = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--scratch") == 0 && i + 1 < argc) {
+            options.scratchDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--max-expansions") == 0 && i + 1 < argc) {
+            options.maxExpansions = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--group") == 0 && i + 1 < argc) {
+            group = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            indexPath = argv[i];
+        }
+    }
+
+    std::vector<BenchPuzzle> puzzles;
+    if (!readCorpus(indexPath, group, puzzles)) return 1;
+    if (puzzles.empty()) {
+        std::cerr << "Bench: no puzzles in " << indexPath << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    std::vector<Board> boards(puzzles.size());
+    std::vector<std::vector<BenchRun> > runs(puzzles.size());
+    for (size_t p = 0; p < puzzles.size(); p++) {
+        LevelSetup level;
+        if (!loadLevelFile(puzzles[p].path, level) || !buildBoard(level, boards[p])) {
+            failures++;
+            continue;
+        }
+        const Board& board = boards[p];
+        std::cout << puzzles[p].group << "/" << puzzles[p].name << ": " << board.cars.size() << " cars, "
+                  << board.keyBits << " key bits" << std::endl;
+
+        int optimal = -1;
+        for (const std::string& solver : solvers) {
+            BenchRun run;
+            run.solver = solver;
+            for (int attempt = 0; attempt < repeat; attempt++) {
+                // A fresh table per run, so repeats and solvers do not warm each other up
+                std::unique_ptr<TranspositionTable> table;
+                SolveOptions runOptions = options;
+                if (solver == "ida" && tableMegabytes > 0) {
+                    table.reset(new TranspositionTable(tableMegabytes));
+                    runOptions.table = table.get();
+                }
+                SolveResult result;
+                run.ok = runSolver(solver, board, runOptions, result);
+                if (!run.ok) break;
+                if (attempt == 0 || result.stats.seconds < run.result.stats.seconds) run.result = result;
+            }
+            run.peakRssBytes = peakResidentBytes();
+
+            std::cout << "  " << std::left << std::setw(9) << solver << std::right << std::setw(11)
+                      << runStatus(run);
+            if (run.result.solved) std::cout << std::setw(5) << run.result.moves.size() << " moves";
+            std::cout << std::fixed << std::setprecision(3) << std::setw(10) << run.result.stats.seconds * 1000.0
+                      << " ms" << std::setprecision(0) << std::setw(12) << run.result.stats.statesPerSecond()
+                      << " nodes/s" << std::setprecision(1) << std::setw(9) << run.peakRssBytes / (1024.0 * 1024.0)
+                      << " MB peak" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+
+            if (!run.ok) failures++;
+            // Every solver here is optimal, so solved runs must agree on the length
+            if (run.result.solved) {
+                if (optimal < 0) {
+                    optimal = (int)run.result.moves.size();
+                } else if ((int)run.result.moves.size() != optimal) {
+                    std::cerr << "Bench: " << solver << " found " << run.result.moves.size() << " moves on "
+                              << puzzles[p].name << ", expected " << optimal << std::endl;
+                    failures++;
+                }
+            }
+            runs[p].push_back(run);
+        }
+    }
+
+    if (jsonPath) {
+        if (!writeJsonReport(jsonPath, indexPath, options, repeat, puzzles, runs, boards)) return 1;
+        std::cout << "Wrote " << jsonPath << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,662 @@
+#include "board.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int toTicks(float value) {
+    return (int)std::lround(value * BOARD_TICKS_PER_UNIT);
+}
+
+static int bitsFor(int slots) {
+    int bits = 0;
+    while ((1 << bits) < slots) bits++;
+    return bits;
+}
+
+// Index of the lowest / highest set bit; `mask` must not be zero
+static inline int lowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+static inline int highestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(mask);
+#endif
+}
+
+#ifdef __SIZEOF_INT128__
+static inline int lowestBit(unsigned __int128 mask) {
+    uint64_t lo = (uint64_t)mask;
+    return lo ? lowestBit(lo) : 64 + lowestBit((uint64_t)(mask >> 64));
+}
+
+static inline int highestBit(unsigned __int128 mask) {
+    uint64_t hi = (uint64_t)(mask >> 64);
+    return hi ? 64 + highestBit(hi) : highestBit((uint64_t)mask);
+}
+#endif
+
+// Box a car sweeps over its whole lane, in ticks
+static void laneBox(const Board& board, const BoardCar& car, int& x0, int& z0, int& x1, int& z1) {
+    int lane0 = car.minCenter - car.halfLength;
+    int lane1 = car.minCenter + (car.slots - 1) * board.slotTicks + car.halfLength;
+    int cross0 = car.crossCenter - car.halfWidth;
+    int cross1 = car.crossCenter + car.halfWidth;
+    x0 = car.vertical ? cross0 : lane0;
+    x1 = car.vertical ? cross1 : lane1;
+    z0 = car.vertical ? lane0 : cross0;
+    z1 = car.vertical ? lane1 : cross1;
+}
+
+// False if cars i and j can never overlap, whatever their slots
+static bool lanesMeet(const Board& board, int i, int j) {
+    int ix0, iz0, ix1, iz1, jx0, jz0, jx1, jz1;
+    laneBox(board, board.cars[i], ix0, iz0, ix1, iz1);
+    laneBox(board, board.cars[j], jx0, jz0, jx1, jz1);
+    return ix0 < jx1 && jx0 < ix1 && iz0 < jz1 && jz0 < iz1;
+}
+
+static void buildLaneMasks(Board& board) {
+    int n = (int)board.cars.size();
+    int longest = 0;
+    for (const BoardCar& car : board.cars) longest = std::max(longest, car.slots);
+    board.laneWords = longest <= 64 ? 1 : longest <= 128 ? 2 : BOARD_LANE_WORDS;
+    board.laneMasks.clear();
+    board.laneLinks.clear();
+    board.laneLinkStart.assign(1, 0);
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            // Cars in far-apart lanes never meet; skip their all-zero masks
+            if (j == i || !lanesMeet(board, i, j)) continue;
+            BoardLaneLink link = {j, (int)board.laneMasks.size()};
+            bool interacts = false;
+            for (int slotJ = 0; slotJ < board.cars[j].slots; slotJ++) {
+                size_t mask = board.laneMasks.size();
+                board.laneMasks.resize(mask + board.laneWords, 0);
+                for (int slotI = 0; slotI < board.cars[i].slots; slotI++) {
+                    if (boardCarsOverlap(board, i, slotI, j, slotJ)) {
+                        board.laneMasks[mask + (slotI >> 6)] |= 1ULL << (slotI & 63);
+                        interacts = true;
+                    }
+                }
+            }
+            if (interacts) {
+                board.laneLinks.push_back(link);
+            } else {
+                board.laneMasks.resize(link.offset);
+            }
+        }
+        board.laneLinkStart.push_back((int)board.laneLinks.size());
+    }
+}
+
+size_t BoardKeyHash::operator()(const BoardKey& key) const {
+    // splitmix64 finalizer over both words
+    uint64_t x = key.lo ^ (key.hi * 0x9E3779B97F4A7C15ULL);
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+// Geometry that makes two cars interchangeable; the start slot is only a tie-break
+static bool sameShapeAndLane(const BoardCar& a, const BoardCar& b) {
+    return a.vertical == b.vertical && a.target == b.target && a.crossCenter == b.crossCenter &&
+           a.minCenter == b.minCenter && a.slots == b.slots && a.halfLength == b.halfLength &&
+           a.halfWidth == b.halfWidth && a.floor == b.floor;
+}
+
+static bool canonicalLess(const BoardCar& a, const BoardCar& b) {
+    if (a.target != b.target) return a.target;
+    if (a.floor != b.floor) return a.floor < b.floor;
+    if (a.vertical != b.vertical) return !a.vertical;
+    if (a.crossCenter != b.crossCenter) return a.crossCenter < b.crossCenter;
+    if (a.minCenter != b.minCenter) return a.minCenter < b.minCenter;
+    if (a.slots != b.slots) return a.slots < b.slots;
+    if (a.halfLength != b.halfLength) return a.halfLength < b.halfLength;
+    if (a.halfWidth != b.halfWidth) return a.halfWidth < b.halfWidth;
+    return a.start < b.start;
+}
+
+static void buildCanonicalForm(Board& board) {
+    int n = (int)board.cars.size();
+    board.canonicalOrder.resize(n);
+    for (int i = 0; i < n; i++) board.canonicalOrder[i] = i;
+    std::stable_sort(board.canonicalOrder.begin(), board.canonicalOrder.end(), [&board](int a, int b) {
+        return canonicalLess(board.cars[a], board.cars[b]);
+    });
+
+    board.interchangeable.clear();
+    for (int first = 0; first < n;) {
+        int last = first + 1;
+        while (last < n && sameShapeAndLane(board.cars[board.canonicalOrder[first]],
+                                            board.cars[board.canonicalOrder[last]])) {
+            last++;
+        }
+        if (last - first > 1 && !board.cars[board.canonicalOrder[first]].target) {
+            board.interchangeable.push_back(
+                std::vector<int>(board.canonicalOrder.begin() + first, board.canonicalOrder.begin() + last));
+        }
+        first = last;
+    }
+}
+
+static bool buildBoardWithRamps(const std::vector<Car>& cars, const std::vector<Ramp>& ramps, Board& board,
+                                float slotSize, float exitLine) {
+    board.cars.clear();
+    board.ramps.clear();
+    for (const Ramp& ramp : ramps) {
+        board.ramps.push_back({ramp.floor, toTicks(ramp.x0), toTicks(ramp.z0), toTicks(ramp.x1), toTicks(ramp.z1)});
+    }
+    board.target = -1;
+    board.exitSlot = 0;
+    board.slotSize = slotSize;
+    board.slotTicks = toTicks(slotSize);
+    board.keyBits = 0;
+    board.laneWords = 0;
+    board.laneMasks.clear();
+    board.laneLinks.clear();
+    board.laneLinkStart.clear();
+    board.canonicalOrder.clear();
+    board.interchangeable.clear();
+
+    if (board.slotTicks <= 0) {
+        std::cerr << "Board: slot size must be positive" << std::endl;
+        return false;
+    }
+    if (cars.size() > 255) {
+        std::cerr << "Board: too many cars (" << cars.size() << ")" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < cars.size(); i++) {
+        const Car& car = cars[i];
+        BoardCar bc;
+        bc.id = car.id;
+        bc.vertical = car.isVertical;
+        bc.target = car.isTarget;
+
+        int minTicks = toTicks(car.minPos);
+        int maxTicks = toTicks(car.maxPos);
+        if (maxTicks < minTicks) {
+            std::cerr << "Board: car " << (i + 1) << " has maxPos < minPos" << std::endl;
+            return false;
+        }
+        bc.slots = (maxTicks - minTicks) / board.slotTicks + 1;
+        if (bc.slots > BOARD_MAX_SLOTS) {
+            std::cerr << "Board: car " << (i + 1) << " has " << bc.slots << " slots (max "
+                      << BOARD_MAX_SLOTS << ")" << std::endl;
+            return false;
+        }
+
+        float lanePos = car.isVertical ? car.position.z : car.position.x;
+        float crossPos = car.isVertical ? car.position.x : car.position.z;
+        float length = car.isVertical ? car.size.z : car.size.x;
+        float width = car.isVertical ? car.size.x : car.size.z;
+
+        bc.minCenter = minTicks;
+        bc.halfLength = toTicks(length * 0.5f);
+        bc.crossCenter = toTicks(crossPos);
+        bc.halfWidth = toTicks(width * 0.5f);
+        bc.floor = carFloor(car);
+
+        int offset = toTicks(lanePos) - minTicks;
+        bc.start = (int)std::lround((double)offset / board.slotTicks);
+        if (bc.start * board.slotTicks != offset) {
+            std::cerr << "Board: car " << (i + 1) << " is off the " << slotSize
+                      << " lattice, snapping to slot " << bc.start << std::endl;
+        }
+        if (bc.start < 0) bc.start = 0;
+        if (bc.start >= bc.slots) bc.start = bc.slots - 1;
+
+        bc.bits = bitsFor(bc.slots);
+        bc.shift = board.keyBits;
+        board.keyBits += bc.bits;
+
+        if (bc.target) {
+            if (board.target >= 0) {
+                std::cerr << "Board: more than one target car" << std::endl;
+                return false;
+            }
+            if (bc.vertical) {
+                std::cerr << "Board: the target car must be horizontal" << std::endl;
+                return false;
+            }
+            if (bc.floor != 0) {
+                std::cerr << "Board: the target car must be on the ground floor" << std::endl;
+                return false;
+            }
+            board.target = (int)i;
+        }
+        board.cars.push_back(bc);
+    }
+
+    if (board.target < 0) {
+        std::cerr << "Board: no target car" << std::endl;
+        return false;
+    }
+
+    const BoardCar& target = board.cars[board.target];
+    int exitTicks = toTicks(exitLine) - target.minCenter;
+    board.exitSlot = exitTicks <= 0 ? 0 : (exitTicks + board.slotTicks - 1) / board.slotTicks;
+    if (board.exitSlot >= target.slots) {
+        std::cerr << "Board: target car can never reach the exit (maxPos too small)" << std::endl;
+        return false;
+    }
+    buildLaneMasks(board);
+    buildCanonicalForm(board);
+    return true;
+}
+
+bool buildBoard(const std::vector<Car>& cars, Board& board, float slotSize, float exitLine) {
+    return buildBoardWithRamps(cars, std::vector<Ramp>(), board, slotSize, exitLine);
+}
+
+bool buildBoard(const LevelSetup& level, Board& board) {
+    return buildBoardWithRamps(level.cars, level.ramps, board, level.slotSize, level.lot.exitX);
+}
+
+BoardState boardStartState(const Board& board) {
+    BoardState state(board.cars.size());
+    for (size_t i = 0; i < board.cars.size(); i++) {
+        state[i] = (uint8_t)board.cars[i].start;
+    }
+    return state;
+}
+
+int boardSlotForPosition(const Board& board, int carIndex, float position) {
+    const BoardCar& car = board.cars[carIndex];
+    int slot = (int)std::lround((double)(toTicks(position) - car.minCenter) / board.slotTicks);
+    if (slot < 0) slot = 0;
+    if (slot >= car.slots) slot = car.slots - 1;
+    return slot;
+}
+
+float boardSlotToPosition(const Board& board, int carIndex, int slot) {
+    const BoardCar& car = board.cars[carIndex];
+    return (float)(car.minCenter + slot * board.slotTicks) / BOARD_TICKS_PER_UNIT;
+}
+
+bool boardCarsOverlap(const Board& board, int a, int slotA, int b, int slotB) {
+    const BoardCar& ca = board.cars[a];
+    const BoardCar& cb = board.cars[b];
+
+    int laneA = ca.minCenter + slotA * board.slotTicks;
+    int laneB = cb.minCenter + slotB * board.slotTicks;
+
+    int xa = ca.vertical ? ca.crossCenter : laneA;
+    int za = ca.vertical ? laneA : ca.crossCenter;
+    int hxa = ca.vertical ? ca.halfWidth : ca.halfLength;
+    int hza = ca.vertical ? ca.halfLength : ca.halfWidth;
+
+    int xb = cb.vertical ? cb.crossCenter : laneB;
+    int zb = cb.vertical ? laneB : cb.crossCenter;
+    int hxb = cb.vertical ? cb.halfWidth : cb.halfLength;
+    int hzb = cb.vertical ? cb.halfLength : cb.halfWidth;
+
+    if (!(std::abs(xa - xb) < hxa + hxb && std::abs(za - zb) < hza + hzb)) return false;
+    if (ca.floor == cb.floor) return true;
+    if (std::abs(ca.floor - cb.floor) != 1) return false;
+
+    // Neighbouring floors: the common part of both footprints must reach into a ramp
+    int x0 = std::max(xa - hxa, xb - hxb);
+    int x1 = std::min(xa + hxa, xb + hxb);
+    int z0 = std::max(za - hza, zb - hzb);
+    int z1 = std::min(za + hza, zb + hzb);
+    int lower = std::min(ca.floor, cb.floor);
+    for (const BoardRamp& ramp : board.ramps) {
+        if (ramp.floor == lower && std::max(x0, ramp.x0) < std::min(x1, ramp.x1) &&
+            std::max(z0, ramp.z0) < std::min(z1, ramp.z1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool boardStateValid(const Board& board, const BoardState& state) {
+    int n = (int)board.cars.size();
+    for (int a = 0; a < n; a++) {
+        if (state[a] >= board.cars[a].slots) return false;
+        for (int b = a + 1; b < n; b++) {
+            if (boardCarsOverlap(board, a, state[a], b, state[b])) return false;
+        }
+    }
+    return true;
+}
+
+bool boardIsSolved(const Board& board, const BoardState& state) {
+    return state[board.target] >= board.exitSlot;
+}
+
+BoardKey packBoardState(const Board& board, const BoardState& state) {
+    BoardKey key = {0, 0};
+    for (size_t i = 0; i < board.cars.size(); i++) {
+        const BoardCar& car = board.cars[i];
+        uint64_t value = state[i];
+        if (car.shift < 64) {
+            key.lo |= value << car.shift;
+            if (car.shift + car.bits > 64) key.hi |= value >> (64 - car.shift);
+        } else {
+            key.hi |= value << (car.shift - 64);
+        }
+    }
+    return key;
+}
+
+void unpackBoardState(const Board& board, const BoardKey& key, BoardState& state) {
+    state.resize(board.cars.size());
+    for (size_t i = 0; i < board.cars.size(); i++) {
+        const BoardCar& car = board.cars[i];
+        uint64_t mask = (1ULL << car.bits) - 1;
+        uint64_t value;
+        if (car.shift < 64) {
+            value = key.lo >> car.shift;
+            if (car.shift + car.bits > 64) value |= key.hi << (64 - car.shift);
+        } else {
+            value = key.hi >> (car.shift - 64);
+        }
+        state[i] = (uint8_t)(value & mask);
+    }
+}
+
+void updateBoardKey(const Board& board, BoardKey& key, int car, int from, int to) {
+    const BoardCar& bc = board.cars[car];
+    uint64_t diff = (uint64_t)(from ^ to);
+    if (bc.shift < 64) {
+        key.lo ^= diff << bc.shift;
+        if (bc.shift + bc.bits > 64) key.hi ^= diff >> (64 - bc.shift);
+    } else {
+        key.hi ^= diff << (bc.shift - 64);
+    }
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void buildZobristTable(const Board& board, ZobristTable& table) {
+    table.values.clear();
+    table.carOffset.clear();
+    for (size_t i = 0; i < board.cars.size(); i++) {
+        table.carOffset.push_back((int)table.values.size());
+        for (int slot = 0; slot < board.cars[i].slots; slot++) {
+            table.values.push_back(splitmix64(((uint64_t)i << 32) | (uint64_t)slot));
+        }
+    }
+}
+
+uint64_t zobristHash(const ZobristTable& table, const BoardState& state) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < state.size(); i++) {
+        hash ^= table.value((int)i, state[i]);
+    }
+    return hash;
+}
+
+// Floors and ramps, mixed in only for garage levels so single-floor boards
+// keep the fingerprints their distance databases were written with
+template <typename CarAt, typename Mix>
+static void mixGarage(const Board& board, size_t carCount, CarAt carAt, Mix& mix) {
+    for (size_t k = 0; k < carCount; k++) {
+        int floor = board.cars[carAt(k)].floor;
+        if (floor != 0) {
+            mix((int64_t)k);
+            mix(floor);
+        }
+    }
+    for (const BoardRamp& ramp : board.ramps) {
+        mix(ramp.floor);
+        mix(ramp.x0);
+        mix(ramp.z0);
+        mix(ramp.x1);
+        mix(ramp.z1);
+    }
+}
+
+uint64_t boardFingerprint(const Board& board) {
+    uint64_t hash = splitmix64((uint64_t)board.cars.size());
+    auto mix = [&hash](int64_t value) { hash = splitmix64(hash ^ (uint64_t)value); };
+    for (const BoardCar& bc : board.cars) {
+        mix(bc.id);
+        mix(bc.vertical);
+        mix(bc.target);
+        mix(bc.slots);
+        mix(bc.start);
+        mix(bc.minCenter);
+        mix(bc.halfLength);
+        mix(bc.crossCenter);
+        mix(bc.halfWidth);
+    }
+    mix(board.exitSlot);
+    mix(board.slotTicks);
+    mixGarage(board, board.cars.size(), [](size_t k) { return (int)k; }, mix);
+    return hash;
+}
+
+void canonicalizeBoardState(const Board& board, BoardState& state, std::vector<int>* labels) {
+    if (labels) {
+        labels->resize(board.cars.size());
+        for (size_t i = 0; i < labels->size(); i++) (*labels)[i] = (int)i;
+    }
+    std::vector<int> bySlot;
+    for (const std::vector<int>& group : board.interchangeable) {
+        bySlot = group;
+        std::stable_sort(bySlot.begin(), bySlot.end(), [&state](int a, int b) { return state[a] < state[b]; });
+        std::vector<uint8_t> slots(bySlot.size());
+        for (size_t k = 0; k < bySlot.size(); k++) slots[k] = state[bySlot[k]];
+        for (size_t k = 0; k < group.size(); k++) {
+            state[group[k]] = slots[k];
+            if (labels) (*labels)[group[k]] = bySlot[k];
+        }
+    }
+}
+
+BoardKey packCanonicalState(const Board& board, const BoardState& state) {
+    BoardState canonical = state;
+    canonicalizeBoardState(board, canonical);
+    BoardKey key = {0, 0};
+    int shift = 0;
+    for (int car : board.canonicalOrder) {
+        uint64_t slot = canonical[car];
+        if (shift < 64) {
+            key.lo |= slot << shift;
+            if (shift + board.cars[car].bits > 64) key.hi |= slot >> (64 - shift);
+        } else {
+            key.hi |= slot << (shift - 64);
+        }
+        shift += board.cars[car].bits;
+    }
+    return key;
+}
+
+uint64_t boardCanonicalFingerprint(const Board& board) {
+    uint64_t hash = splitmix64((uint64_t)board.cars.size());
+    auto mix = [&hash](int64_t value) { hash = splitmix64(hash ^ (uint64_t)value); };
+    // canonicalOrder lists identical cars by start slot, so the start is canonical too
+    for (int car : board.canonicalOrder) {
+        const BoardCar& bc = board.cars[car];
+        mix(bc.vertical);
+        mix(bc.target);
+        mix(bc.slots);
+        mix(bc.start);
+        mix(bc.minCenter);
+        mix(bc.halfLength);
+        mix(bc.crossCenter);
+        mix(bc.halfWidth);
+    }
+    mix(board.exitSlot);
+    mix(board.slotTicks);
+    mixGarage(board, board.cars.size(), [&board](size_t k) { return board.canonicalOrder[k]; }, mix);
+    return hash;
+}
+
+// Occupancy bitboard of one lane (bit n = slot n) for LANE_WORDS words of
+// slots: a single word, a 128-bit integer where the compiler has one, or an
+// array of words
+template <int WORDS>
+struct LaneBits {
+    uint64_t word[WORDS];
+};
+
+template <int WORDS> struct LaneMaskType { typedef LaneBits<WORDS> type; };
+template <> struct LaneMaskType<1> { typedef uint64_t type; };
+#ifdef __SIZEOF_INT128__
+template <> struct LaneMaskType<2> { typedef unsigned __int128 type; };
+#endif
+
+// Marks every slot from `slots` on, past the lane's end, as blocked
+template <typename Mask>
+static inline void fillPastLane(Mask& blocked, int slots) {
+    const int bits = (int)sizeof(Mask) * 8;
+    blocked = slots == bits ? 0 : ~(Mask)0 << slots;
+}
+
+template <int WORDS>
+static inline void fillPastLane(LaneBits<WORDS>& blocked, int slots) {
+    for (int w = 0; w < WORDS; w++) {
+        int first = slots - 64 * w;
+        blocked.word[w] = first <= 0 ? ~0ULL : first >= 64 ? 0 : ~0ULL << first;
+    }
+}
+
+// ORs one mask of Board::laneMasks into `blocked`
+static inline void orLaneMask(uint64_t& blocked, const uint64_t* words) {
+    blocked |= words[0];
+}
+
+#ifdef __SIZEOF_INT128__
+static inline void orLaneMask(unsigned __int128& blocked, const uint64_t* words) {
+    blocked |= (unsigned __int128)words[1] << 64 | words[0];
+}
+#endif
+
+template <int WORDS>
+static inline void orLaneMask(LaneBits<WORDS>& blocked, const uint64_t* words) {
+    for (int w = 0; w < WORDS; w++) blocked.word[w] |= words[w];
+}
+
+// Free slots below (`back`) and above (`forward`) the car in `slot`
+template <typename Mask>
+static inline void freeRun(const Mask& blocked, int slot, int& back, int& forward) {
+    const int bits = (int)sizeof(Mask) * 8;
+    Mask below = blocked & (((Mask)1 << slot) - 1);
+    back = below ? slot - 1 - highestBit(below) : slot;
+    forward = bits - 1 - slot;
+    if (slot < bits - 1) {
+        Mask above = blocked >> (slot + 1);
+        if (above) forward = lowestBit(above);
+    }
+}
+
+template <int WORDS>
+static inline void freeRun(const LaneBits<WORDS>& blocked, int slot, int& back, int& forward) {
+    int word = slot >> 6;
+    int bit = slot & 63;
+    back = slot;
+    uint64_t below = blocked.word[word] & ((1ULL << bit) - 1);
+    for (int w = word; w >= 0; w--) {
+        if (w < word) below = blocked.word[w];
+        if (below) {
+            back = slot - 1 - (64 * w + highestBit(below));
+            break;
+        }
+    }
+    forward = 64 * WORDS - 1 - slot;
+    uint64_t above = blocked.word[word] & ~((2ULL << bit) - 1);
+    for (int w = word; w < WORDS; w++) {
+        if (w > word) above = blocked.word[w];
+        if (above) {
+            forward = 64 * w + lowestBit(above) - slot - 1;
+            break;
+        }
+    }
+}
+
+template <int LANE_WORDS>
+void generateBoardMovesFor(const Board& board, const BoardState& state, std::vector<BoardMove>& moves) {
+    typedef typename LaneMaskType<LANE_WORDS>::type Mask;
+    moves.clear();
+    int n = (int)board.cars.size();
+    const uint64_t* masks = board.laneMasks.data();
+    for (int i = 0; i < n; i++) {
+        // Occupancy of car i's lane: other cars' slots plus everything past the lane's end
+        Mask blocked;
+        fillPastLane(blocked, board.cars[i].slots);
+        for (int k = board.laneLinkStart[i]; k < board.laneLinkStart[i + 1]; k++) {
+            const BoardLaneLink& link = board.laneLinks[k];
+            orLaneMask(blocked, masks + link.offset + state[link.other] * LANE_WORDS);
+        }
+
+        int back, forward;
+        freeRun(blocked, state[i], back, forward);
+        for (int d = 1; d <= back; d++) moves.push_back({(uint8_t)i, (int16_t)-d});
+        for (int d = 1; d <= forward; d++) moves.push_back({(uint8_t)i, (int16_t)d});
+    }
+}
+
+template void generateBoardMovesFor<1>(const Board&, const BoardState&, std::vector<BoardMove>&);
+template void generateBoardMovesFor<2>(const Board&, const BoardState&, std::vector<BoardMove>&);
+template void generateBoardMovesFor<BOARD_LANE_WORDS>(const Board&, const BoardState&, std::vector<BoardMove>&);
+
+void generateBoardMoves(const Board& board, const BoardState& state, std::vector<BoardMove>& moves) {
+    if (board.laneWords == 1) {
+        generateBoardMovesFor<1>(board, state, moves);
+    } else if (board.laneWords == 2) {
+        generateBoardMovesFor<2>(board, state, moves);
+    } else {
+        generateBoardMovesFor<BOARD_LANE_WORDS>(board, state, moves);
+    }
+}
+
+void generateBoardMovesScan(const Board& board, const BoardState& state, std::vector<BoardMove>& moves) {
+    moves.clear();
+    int n = (int)board.cars.size();
+    for (int i = 0; i < n; i++) {
+        const BoardCar& car = board.cars[i];
+        for (int dir = -1; dir <= 1; dir += 2) {
+            for (int slot = state[i] + dir; slot >= 0 && slot < car.slots; slot += dir) {
+                bool blocked = false;
+                for (int j = 0; j < n && !blocked; j++) {
+                    if (j != i && boardCarsOverlap(board, i, slot, j, state[j])) blocked = true;
+                }
+                if (blocked) break;
+                moves.push_back({(uint8_t)i, (int16_t)(slot - state[i])});
+            }
+        }
+    }
+}
+
+std::string describeBoardMove(const Board& board, const BoardMove& move) {
+    const BoardCar& car = board.cars[move.car];
+    const char* direction;
+    if (car.vertical) {
+        direction = move.delta < 0 ? "UP" : "DOWN";
+    } else {
+        direction = move.delta < 0 ? "LEFT" : "RIGHT";
+    }
+    std::stringstream ss;
+    ss << "CAR " << (move.car + 1) << " " << direction << " " << std::abs(move.delta) * board.slotSize;
+    return ss.str();
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "car.h"
+#include "levels.h"
+
+// Discrete view of a level used by the solvers.
+//
+// Every car slides along its lane between Car::minPos and Car::maxPos in steps
+// of slotSize world units; slot 0 is minPos. Extents are stored in ticks
+// (1/40 world unit) so the overlap test is exact integer math and matches
+// checkCollision for any position on the lattice.
+
+const float BOARD_SLOT_SIZE = 0.5f;
+const int BOARD_TICKS_PER_UNIT = 40;
+const float EXIT_LINE_X = 5.5f;      // default win line, LotLayout::exitX of the 12x12 lot
+const int BOARD_MAX_SLOTS = 255;     // slots are stored as uint8_t
+const int BOARD_KEY_BITS = 128;
+const int BOARD_LANE_WORDS = 4;      // 64-bit words of the widest lane bitboard, >= BOARD_MAX_SLOTS bits
+
+struct BoardCar {
+    int id;
+    bool vertical;
+    bool target;
+    int slots;          // lattice positions from minPos to maxPos
+    int start;          // slot of the car when the board was built
+    int bits;           // bits this car takes in a packed key
+    int shift;          // bit offset of this car in a packed key
+    int minCenter;      // lane-axis center at slot 0, ticks
+    int halfLength;     // half extent along the lane, ticks
+    int crossCenter;    // fixed center across the lane, ticks
+    int halfWidth;      // half extent across the lane, ticks
+    int floor;          // garage floor (carFloor); cars on other floors meet only in ramps
+};
+
+// Ramp::floor and its rectangle, in ticks
+struct BoardRamp {
+    int floor;
+    int x0, z0, x1, z1;
+};
+
+// Car `other` can block the car that owns this link; the laneWords words at
+// laneMasks[offset + s * laneWords] are the set of the owner's slots (bit n =
+// slot n) that overlap `other` while it sits in slot s
+struct BoardLaneLink {
+    int other;
+    int offset;
+};
+
+struct Board {
+    std::vector<BoardCar> cars;
+    int target;         // index of the target car
+    int exitSlot;       // first target slot that wins
+    float slotSize;
+    int slotTicks;
+    int keyBits;        // total bits of a packed key
+    std::vector<BoardRamp> ramps;
+
+    // Lane bitboards for generateBoardMoves, sized for the board's longest
+    // lane: laneWords 64-bit words per mask, 1 (up to 64 slots), 2 (128) or
+    // BOARD_LANE_WORDS, stored back to back in laneMasks
+    int laneWords;
+    std::vector<uint64_t> laneMasks;
+    std::vector<BoardLaneLink> laneLinks;
+    std::vector<int> laneLinkStart;     // links of car i: [laneLinkStart[i], laneLinkStart[i + 1])
+
+    // Cars identified by shape and lane rather than id/color: canonicalOrder
+    // sorts the cars by geometry (ties by start slot), and each entry of
+    // interchangeable lists non-target cars, two or more, with the same lane,
+    // shape and travel, in canonicalOrder (so by start slot)
+    std::vector<int> canonicalOrder;
+    std::vector<std::vector<int>> interchangeable;
+};
+
+// Slot per car, indexed like Board::cars
+typedef std::vector<uint8_t> BoardState;
+
+// A state packed into 128 bits; boards needing fewer bits leave `hi` zero
+struct BoardKey {
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const BoardKey& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const BoardKey& other) const { return !(*this == other); }
+    bool operator<(const BoardKey& other) const { return hi != other.hi ? hi < other.hi : lo < other.lo; }
+};
+
+// Searches keep a bare uint64_t per state when the board packs into 64 bits
+// (keyBits <= 64), full BoardKeys otherwise
+template <typename Key> struct BoardKeyCodec;
+
+template <> struct BoardKeyCodec<uint64_t> {
+    static uint64_t encode(const BoardKey& key) { return key.lo; }
+    static BoardKey decode(uint64_t key) { return BoardKey{key, 0}; }
+};
+
+template <> struct BoardKeyCodec<BoardKey> {
+    static BoardKey encode(const BoardKey& key) { return key; }
+    static BoardKey decode(const BoardKey& key) { return key; }
+};
+
+struct BoardKeyHash {
+    size_t operator()(const BoardKey& key) const;
+};
+
+// One slide of one car; delta is in slots (positive = +x / +z)
+struct BoardMove {
+    uint8_t car;
+    int16_t delta;      // up to BOARD_MAX_SLOTS - 1 either way
+};
+
+// Discretizes a level; prints the reason to std::cerr and returns false if the
+// layout cannot be represented (no target, too many slots, ...). The target
+// wins once its position.x reaches exitLine.
+bool buildBoard(const std::vector<Car>& cars, Board& board, float slotSize = BOARD_SLOT_SIZE,
+                float exitLine = EXIT_LINE_X);
+
+// The same with the level's slot size, exit line and ramps
+bool buildBoard(const LevelSetup& level, Board& board);
+
+BoardState boardStartState(const Board& board);
+
+// Nearest lattice slot for a live car position
+int boardSlotForPosition(const Board& board, int carIndex, float position);
+float boardSlotToPosition(const Board& board, int carIndex, int slot);
+
+// Same rule as carsOverlap: one floor, or neighbouring floors inside a ramp
+bool boardCarsOverlap(const Board& board, int a, int slotA, int b, int slotB);
+bool boardStateValid(const Board& board, const BoardState& state);
+bool boardIsSolved(const Board& board, const BoardState& state);
+
+// The packed-key functions need board.keyBits <= BOARD_KEY_BITS; buildBoard
+// accepts wider boards, so callers that pack keys check it first
+BoardKey packBoardState(const Board& board, const BoardState& state);
+void unpackBoardState(const Board& board, const BoardKey& key, BoardState& state);
+
+// Every legal slide from `state` (any distance, no jumping over cars). Per car,
+// the masks of the cars that can reach its lane are ORed into one occupancy
+// bitboard and the free run either side of the car is read off with a
+// count-trailing/leading-zeros, so the cost is a few instructions per car
+// instead of an overlap test per car pair per slot.
+void generateBoardMoves(const Board& board, const BoardState& state, std::vector<BoardMove>& moves);
+
+// generateBoardMoves for a board whose laneWords is LANE_WORDS. The occupancy
+// type is fixed at compile time: uint64_t for 1 word, unsigned __int128 (where
+// the compiler has it) for 2, an array of words otherwise. Instantiated for 1,
+// 2 and BOARD_LANE_WORDS; solvers call it directly to skip the dispatch.
+template <int LANE_WORDS>
+void generateBoardMovesFor(const Board& board, const BoardState& state, std::vector<BoardMove>& moves);
+
+// Reference generator: tests every slot against every other car. Same moves in
+// the same order as generateBoardMoves.
+void generateBoardMovesScan(const Board& board, const BoardState& state, std::vector<BoardMove>& moves);
+
+inline void applyBoardMove(BoardState& state, const BoardMove& move) {
+    state[move.car] = (uint8_t)(state[move.car] + move.delta);
+}
+
+// O(1) update of a packed key when one car goes from slot `from` to `to`
+void updateBoardKey(const Board& board, BoardKey& key, int car, int from, int to);
+
+// Zobrist keys: one random 64-bit value per (car, slot), XORed over the cars.
+// The values depend only on the car index and slot, so the live game and the
+// solvers agree on the hash of a state without sharing a table instance.
+struct ZobristTable {
+    std::vector<uint64_t> values;
+    std::vector<int> carOffset;
+
+    uint64_t value(int car, int slot) const { return values[carOffset[car] + slot]; }
+};
+
+void buildZobristTable(const Board& board, ZobristTable& table);
+uint64_t zobristHash(const ZobristTable& table, const BoardState& state);
+
+inline uint64_t zobristMove(const ZobristTable& table, uint64_t hash, int car, int from, int to) {
+    return hash ^ table.value(car, from) ^ table.value(car, to);
+}
+
+// Canonical form: within every group of interchangeable cars the slots are
+// sorted so the group's first car gets the lowest slot (the start state is
+// already canonical). Equivalent states (the same
+// picture with identical cars swapped) become one state. If `labels` is given
+// it maps each car of the canonical state to the car of `state` it stands for.
+//
+// Cars of a group share a lane and cannot pass each other, so a move from a
+// canonical state always leads to another canonical state: a search only has
+// to canonicalize its start and relabel the moves it returns.
+void canonicalizeBoardState(const Board& board, BoardState& state, std::vector<int>* labels = NULL);
+
+inline void relabelBoardMoves(const std::vector<int>& labels, std::vector<BoardMove>& moves) {
+    for (BoardMove& move : moves) move.car = (uint8_t)labels[move.car];
+}
+
+// Packs the canonical form of `state` with the cars in canonicalOrder, so
+// two boards that differ only in car ids, colors or the order the level lists
+// its cars give equal keys for equivalent states
+BoardKey packCanonicalState(const Board& board, const BoardState& state);
+
+// Like boardFingerprint, but ignores ids and car order (see packCanonicalState)
+uint64_t boardCanonicalFingerprint(const Board& board);
+
+// Hash of the discretized geometry (lanes, extents, slots, exit); files built
+// for one board refuse to load against a level that has since changed
+uint64_t boardFingerprint(const Board& board);
+
+// "CAR 3 UP 1.5" - car numbers match the 1-9 selection keys
+std::string describeBoardMove(const Board& board, const BoardMove& move);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+struct Car {
+    glm::vec3 position;
+    glm::vec3 size;
+    glm::vec3 baseColor;
+    bool isVertical;
+    bool isTarget;
+    int id;
+    float minPos;
+    float maxPos;
+};
+
+// Garage levels stack floors FLOOR_HEIGHT apart; a car's floor is read off its
+// height, so single-floor levels (every car at CAR_GROUND_Y) need no new data
+constexpr float CAR_GROUND_Y = 0.4f;
+constexpr float FLOOR_HEIGHT = 3.0f;
+
+inline int carFloor(const Car& car) {
+    return (int)std::lround((car.position.y - CAR_GROUND_Y) / FLOOR_HEIGHT);
+}
@@ -0,0 +1,187 @@
+#include "collision_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+CollisionGrid::CollisionGrid() : originX(0.0f), originZ(0.0f), bucketSize(1.0f), columns(0), rows(0) {}
+
+void CollisionGrid::build(const std::vector<Car>& cars, const LotLayout& lot, int floor) {
+    // One bucket per grid cell; cars past the slab (the target leaving through
+    // the exit) land in the edge buckets, which keeps the test exact
+    bucketSize = lot.cell > 0.0f ? lot.cell : 1.0f;
+    originX = -0.5f * lot.width;
+    originZ = -0.5f * lot.depth;
+    columns = std::max(1, (int)std::ceil(lot.width / bucketSize));
+    rows = std::max(1, (int)std::ceil(lot.depth / bucketSize));
+
+    buckets.assign((size_t)columns * rows, std::vector<Entry>());
+    verticalStart.assign(buckets.size(), 0);
+    spans.resize(cars.size());
+    for (size_t i = 0; i < cars.size(); i++) {
+        if (carFloor(cars[i]) != floor) continue;
+        spans[i] = spanFor(cars[i], cars[i].position);
+        insert(entryFor(cars[i], (int)i), cars[i].isVertical, spans[i]);
+    }
+}
+
+CollisionGrid::Span CollisionGrid::spanFor(float x0, float z0, float x1, float z1) const {
+    auto bucket = [this](float offset, int count) {
+        return std::min(count - 1, std::max(0, (int)std::floor(offset / bucketSize)));
+    };
+    Span span;
+    span.x0 = bucket(x0 - originX, columns);
+    span.x1 = bucket(x1 - originX, columns);
+    span.z0 = bucket(z0 - originZ, rows);
+    span.z1 = bucket(z1 - originZ, rows);
+    return span;
+}
+
+CollisionGrid::Span CollisionGrid::spanFor(const Car& car, const glm::vec3& position) const {
+    return spanFor(position.x - car.size.x / 2, position.z - car.size.z / 2, position.x + car.size.x / 2,
+                   position.z + car.size.z / 2);
+}
+
+CollisionGrid::Entry CollisionGrid::entryFor(const Car& car, int carIndex) {
+    float x0 = car.position.x - car.size.x / 2;
+    float x1 = car.position.x + car.size.x / 2;
+    float z0 = car.position.z - car.size.z / 2;
+    float z1 = car.position.z + car.size.z / 2;
+    if (car.isVertical) return {z0, z1, x0, x1, carIndex};
+    return {x0, x1, z0, z1, carIndex};
+}
+
+void CollisionGrid::insert(const Entry& entry, bool vertical, const Span& span) {
+    for (int z = span.z0; z <= span.z1; z++) {
+        for (int x = span.x0; x <= span.x1; x++) {
+            size_t index = (size_t)z * columns + x;
+            if (vertical) {
+                buckets[index].push_back(entry);
+            } else {
+                buckets[index].insert(buckets[index].begin() + verticalStart[index]++, entry);
+            }
+        }
+    }
+}
+
+void CollisionGrid::remove(int carIndex, bool vertical, const Span& span) {
+    for (int z = span.z0; z <= span.z1; z++) {
+        for (int x = span.x0; x <= span.x1; x++) {
+            size_t index = (size_t)z * columns + x;
+            std::vector<Entry>& bucket = buckets[index];
+            bucket.erase(std::find_if(bucket.begin(), bucket.end(),
+                                      [carIndex](const Entry& entry) { return entry.car == carIndex; }));
+            if (!vertical) verticalStart[index]--;
+        }
+    }
+}
+
+// The overlap test for one group of a bucket: cars sliding along LANE_AXIS
+// (0 = x, 2 = z), against the box x0..x1, z0..z1 mapped onto their lane and
+// cross-lane axes at compile time. Every entry is tested and the results are
+// ORed, so the loop has no data-dependent branch.
+template <int LANE_AXIS>
+bool CollisionGrid::groupOverlaps(const Entry* first, const Entry* last, int carIndex, float x0, float z0, float x1,
+                                  float z1) {
+    const float lane0 = LANE_AXIS == 0 ? x0 : z0;
+    const float lane1 = LANE_AXIS == 0 ? x1 : z1;
+    const float cross0 = LANE_AXIS == 0 ? z0 : x0;
+    const float cross1 = LANE_AXIS == 0 ? z1 : x1;
+    bool hit = false;
+    for (const Entry* other = first; other != last; other++) {
+        hit |= (other->car != carIndex) & (lane0 < other->lane1) & (lane1 > other->lane0) &
+               (cross0 < other->cross1) & (cross1 > other->cross0);
+    }
+    return hit;
+}
+
+bool CollisionGrid::collides(const std::vector<Car>& cars, int carIndex, const glm::vec3& position) const {
+    const Car& car = cars[carIndex];
+    return overlaps(carIndex, position.x - car.size.x / 2, position.z - car.size.z / 2,
+                    position.x + car.size.x / 2, position.z + car.size.z / 2);
+}
+
+bool CollisionGrid::overlaps(int carIndex, float x0, float z0, float x1, float z1) const {
+    Span span = spanFor(x0, z0, x1, z1);
+    for (int z = span.z0; z <= span.z1; z++) {
+        for (int x = span.x0; x <= span.x1; x++) {
+            size_t index = (size_t)z * columns + x;
+            const Entry* entries = buckets[index].data();
+            const Entry* split = entries + verticalStart[index];
+            if (groupOverlaps<0>(entries, split, carIndex, x0, z0, x1, z1) ||
+                groupOverlaps<2>(split, entries + buckets[index].size(), carIndex, x0, z0, x1, z1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CollisionGrid::update(const std::vector<Car>& cars, int carIndex) {
+    const Car& car = cars[carIndex];
+    Span span = spanFor(car, car.position);
+    Entry entry = entryFor(car, carIndex);
+    if (!(span == spans[carIndex])) {
+        remove(carIndex, car.isVertical, spans[carIndex]);
+        insert(entry, car.isVertical, span);
+        spans[carIndex] = span;
+        return;
+    }
+    // Same buckets: refresh the stored footprint in place
+    for (int z = span.z0; z <= span.z1; z++) {
+        for (int x = span.x0; x <= span.x1; x++) {
+            for (Entry& stored : buckets[(size_t)z * columns + x]) {
+                if (stored.car == carIndex) stored = entry;
+            }
+        }
+    }
+}
+
+void GarageCollision::build(const std::vector<Car>& cars, const LotLayout& lot, const std::vector<Ramp>& levelRamps) {
+    int floorCount = 1;
+    for (const Car& car : cars) floorCount = std::max(floorCount, carFloor(car) + 1);
+    for (const Ramp& ramp : levelRamps) floorCount = std::max(floorCount, ramp.floor + 2);
+
+    floors.resize(floorCount);
+    for (int f = 0; f < floorCount; f++) floors[f].build(cars, lot, f);
+    ramps = levelRamps;
+}
+
+const CollisionGrid* GarageCollision::grid(int floor) const {
+    return floor >= 0 && floor < (int)floors.size() ? &floors[floor] : NULL;
+}
+
+bool GarageCollision::collides(const std::vector<Car>& cars, int carIndex, const glm::vec3& position) const {
+    const Car& car = cars[carIndex];
+    int floor = carFloor(car);
+    const CollisionGrid* own = grid(floor);
+    if (own && own->collides(cars, carIndex, position)) return true;
+
+    float x0 = position.x - car.size.x / 2;
+    float x1 = position.x + car.size.x / 2;
+    float z0 = position.z - car.size.z / 2;
+    float z1 = position.z + car.size.z / 2;
+    for (const Ramp& ramp : ramps) {
+        int other;
+        if (ramp.floor == floor) {
+            other = floor + 1;
+        } else if (ramp.floor == floor - 1) {
+            other = floor - 1;
+        } else {
+            continue;
+        }
+        // Only the part of the car inside the ramp can meet the other floor
+        float rx0 = std::max(x0, ramp.x0);
+        float rx1 = std::min(x1, ramp.x1);
+        float rz0 = std::max(z0, ramp.z0);
+        float rz1 = std::min(z1, ramp.z1);
+        if (!(rx0 < rx1 && rz0 < rz1)) continue;
+        const CollisionGrid* neighbour = grid(other);
+        if (neighbour && neighbour->overlaps(carIndex, rx0, rz0, rx1, rz1)) return true;
+    }
+    return false;
+}
+
+void GarageCollision::update(const std::vector<Car>& cars, int carIndex) {
+    int floor = carFloor(cars[carIndex]);
+    if (grid(floor)) floors[floor].update(cars, carIndex);
+}
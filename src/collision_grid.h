@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "car.h"
+#include "levels.h"
+
+// Uniform grid of buckets over the lot for the live overlap test. Each car is
+// listed in every bucket its footprint covers, so a moving car is only tested
+// against the few cars around it instead of every car in the level. Only the
+// car that moved has to be re-filed.
+//
+// A bucket keeps its cars' footprints in two groups, cars sliding along x and
+// cars sliding along z, each stored as lane / cross-lane intervals. The test
+// runs a branch-free kernel per group, specialized on the group's lane axis,
+// straight over the bucket's entries without looking at the Car objects.
+class CollisionGrid {
+public:
+    CollisionGrid();
+
+    // Files the cars standing on `floor` (see carFloor); the others are ignored
+    void build(const std::vector<Car>& cars, const LotLayout& lot, int floor = 0);
+
+    // True if car `carIndex` at `position` would overlap another car; the same
+    // test checkCollision always made, against the nearby cars only
+    bool collides(const std::vector<Car>& cars, int carIndex, const glm::vec3& position) const;
+
+    // True if a filed car other than `carIndex` reaches into the x/z box
+    bool overlaps(int carIndex, float x0, float z0, float x1, float z1) const;
+
+    // Re-files a car after it moved
+    void update(const std::vector<Car>& cars, int carIndex);
+
+private:
+    struct Span {
+        int x0, z0, x1, z1;     // bucket range covered, inclusive
+
+        bool operator==(const Span& other) const {
+            return x0 == other.x0 && z0 == other.z0 && x1 == other.x1 && z1 == other.z1;
+        }
+    };
+
+    // A filed car's footprint along and across its lane
+    struct Entry {
+        float lane0, lane1;
+        float cross0, cross1;
+        int car;
+    };
+
+    Span spanFor(float x0, float z0, float x1, float z1) const;
+    Span spanFor(const Car& car, const glm::vec3& position) const;
+    static Entry entryFor(const Car& car, int carIndex);
+    void insert(const Entry& entry, bool vertical, const Span& span);
+    void remove(int carIndex, bool vertical, const Span& span);
+    template <int LANE_AXIS>
+    static bool groupOverlaps(const Entry* first, const Entry* last, int carIndex, float x0, float z0, float x1,
+                              float z1);
+
+    float originX, originZ;
+    float bucketSize;
+    int columns, rows;
+    // Per bucket, row-major: the cars sliding along x, then from
+    // verticalStart[bucket] on the cars sliding along z
+    std::vector<std::vector<Entry> > buckets;
+    std::vector<int> verticalStart;
+    std::vector<Span> spans;                    // where each filed car is
+};
+
+// One CollisionGrid per floor of a garage level. A moving car is tested
+// against its own floor, and where it reaches into a ramp, against the cars of
+// the floor the ramp leads to inside the ramp only; the cars of every other
+// floor are never looked at.
+class GarageCollision {
+public:
+    void build(const std::vector<Car>& cars, const LotLayout& lot, const std::vector<Ramp>& ramps);
+
+    // carsOverlap against every other car, via the grids
+    bool collides(const std::vector<Car>& cars, int carIndex, const glm::vec3& position) const;
+
+    void update(const std::vector<Car>& cars, int carIndex);
+
+private:
+    const CollisionGrid* grid(int floor) const;
+
+    std::vector<CollisionGrid> floors;
+    std::vector<Ramp> ramps;
+};
@@ -0,0 +1,262 @@
+#include "distance_db.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "process_stats.h"
+
+static const uint16_t UNKNOWN_DISTANCE = 0xFFFF;
+
+std::string distanceDatabasePath(const std::string& directory, int levelNumber) {
+    std::stringstream ss;
+    ss << directory << "/level" << levelNumber << ".pjdb";
+    return ss.str();
+}
+
+static size_t keyBytes(uint32_t keyWords) {
+    return keyWords == 1 ? sizeof(uint64_t) : sizeof(BoardKey);
+}
+
+bool buildDistanceDatabase(const Board& board, const std::string& path, uint64_t maxStates,
+                           DistanceDbBuildStats& stats) {
+    stats = DistanceDbBuildStats();
+    double startTime = monotonicSeconds();
+    if (board.keyBits > BOARD_KEY_BITS) {
+        std::cerr << "Distance database: board needs " << board.keyBits << " key bits (max " << BOARD_KEY_BITS << ")"
+                  << std::endl;
+        return false;
+    }
+
+    // Forward BFS: collect every state a player can reach. Winning states are
+    // kept but not expanded, since the level ends there.
+    std::vector<BoardKey> keys;
+    std::unordered_map<BoardKey, uint32_t, BoardKeyHash> index;
+    std::vector<uint32_t> goals;
+    BoardState state = boardStartState(board);
+    BoardKey startKey = packBoardState(board, state);
+    keys.push_back(startKey);
+    index.emplace(startKey, 0);
+
+    std::vector<BoardMove> moves;
+    for (size_t next = 0; next < keys.size(); next++) {
+        unpackBoardState(board, keys[next], state);
+        if (boardIsSolved(board, state)) {
+            goals.push_back((uint32_t)next);
+            continue;
+        }
+        generateBoardMoves(board, state, moves);
+        for (const BoardMove& move : moves) {
+            BoardKey child = keys[next];
+            updateBoardKey(board, child, move.car, state[move.car], state[move.car] + move.delta);
+            if (index.emplace(child, (uint32_t)keys.size()).second) {
+                keys.push_back(child);
+                if (keys.size() > maxStates) {
+                    std::cerr << "Distance database: more than " << maxStates << " reachable states" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Retrograde BFS from every winning state at once. Slides are reversible,
+    // so the predecessors of a state are the states its own moves lead to.
+    std::vector<uint16_t> distance(keys.size(), UNKNOWN_DISTANCE);
+    std::vector<uint32_t> queue(goals);
+    for (uint32_t goal : goals) distance[goal] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint32_t current = queue[head];
+        int nextDistance = distance[current] + 1;
+        if (nextDistance >= DISTANCE_DB_UNSOLVABLE) {
+            std::cerr << "Distance database: distance does not fit in 16 bits" << std::endl;
+            return false;
+        }
+        unpackBoardState(board, keys[current], state);
+        generateBoardMoves(board, state, moves);
+        for (const BoardMove& move : moves) {
+            BoardKey neighbour = keys[current];
+            updateBoardKey(board, neighbour, move.car, state[move.car], state[move.car] + move.delta);
+            auto it = index.find(neighbour);
+            if (it == index.end() || distance[it->second] != UNKNOWN_DISTANCE) continue;
+            distance[it->second] = (uint16_t)nextDistance;
+            queue.push_back(it->second);
+            stats.maxDistance = std::max(stats.maxDistance, nextDistance);
+        }
+    }
+    index.clear();
+
+    std::vector<uint32_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (uint32_t)i;
+    std::sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    DistanceDbHeader header = {};
+    header.magic = DISTANCE_DB_MAGIC;
+    header.version = DISTANCE_DB_VERSION;
+    header.fingerprint = boardFingerprint(board);
+    header.count = keys.size();
+    header.keyWords = board.keyBits <= 64 ? 1 : 2;
+    header.maxDistance = (uint32_t)stats.maxDistance;
+    header.startDistance = distance[0];
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    out.write((const char*)&header, sizeof(header));
+    for (uint32_t i : order) {
+        if (header.keyWords == 1) {
+            out.write((const char*)&keys[i].lo, sizeof(uint64_t));
+        } else {
+            out.write((const char*)&keys[i], sizeof(BoardKey));
+        }
+    }
+    for (uint32_t i : order) {
+        out.write((const char*)&distance[i], sizeof(uint16_t));
+    }
+    if (!out) {
+        std::cerr << "Failed writing " << path << std::endl;
+        return false;
+    }
+
+    stats.states = keys.size();
+    stats.solvable = queue.size();
+    stats.startDistance = distance[0];
+    stats.seconds = monotonicSeconds() - startTime;
+    stats.fileBytes = sizeof(header) + keys.size() * (keyBytes(header.keyWords) + sizeof(uint16_t));
+    return true;
+}
+
+DistanceDatabase::DistanceDatabase()
+    : header(NULL), narrowKeys(NULL), wideKeys(NULL), distances(NULL) {}
+
+bool DistanceDatabase::open(const std::string& path, const Board& board) {
+    close();
+    if (!file.open(path)) return false;
+
+    const DistanceDbHeader* candidate = (const DistanceDbHeader*)file.data();
+    if (file.size() < sizeof(DistanceDbHeader) || candidate->magic != DISTANCE_DB_MAGIC ||
+        candidate->version != DISTANCE_DB_VERSION ||
+        (candidate->keyWords != 1 && candidate->keyWords != 2)) {
+        std::cerr << path << " is not a distance database" << std::endl;
+        file.close();
+        return false;
+    }
+    // Divide rather than multiply: a corrupt count must not wrap back to the file size
+    size_t recordBytes = keyBytes(candidate->keyWords) + sizeof(uint16_t);
+    size_t payload = file.size() - sizeof(DistanceDbHeader);
+    if (payload % recordBytes != 0 || candidate->count != payload / recordBytes) {
+        std::cerr << path << " is truncated" << std::endl;
+        file.close();
+        return false;
+    }
+    if (candidate->fingerprint != boardFingerprint(board)) {
+        std::cerr << path << " was built for a different layout; rebuild it" << std::endl;
+        file.close();
+        return false;
+    }
+
+    header = candidate;
+    const uint8_t* keyData = file.data() + sizeof(DistanceDbHeader);
+    if (header->keyWords == 1) {
+        narrowKeys = (const uint64_t*)keyData;
+    } else {
+        wideKeys = (const BoardKey*)keyData;
+    }
+    distances = (const uint16_t*)(keyData + header->count * keyBytes(header->keyWords));
+    return true;
+}
+
+void DistanceDatabase::close() {
+    file.close();
+    header = NULL;
+    narrowKeys = NULL;
+    wideKeys = NULL;
+    distances = NULL;
+}
+
+bool DistanceDatabase::findIndex(const BoardKey& key, uint64_t& found) const {
+    if (!header || header->count == 0) return false;
+
+    if (wideKeys) {
+        const BoardKey* end = wideKeys + header->count;
+        const BoardKey* it = std::lower_bound(wideKeys, end, key);
+        if (it == end || *it != key) return false;
+        found = (uint64_t)(it - wideKeys);
+        return true;
+    }
+
+    if (key.hi != 0) return false;
+    uint64_t target = key.lo;
+
+    // Interpolation search: packed keys of reachable states spread fairly evenly,
+    // so a guess from the key's value usually lands a few entries away. Fall back
+    // to bisection whenever a guess fails to halve the range, which keeps the
+    // worst case logarithmic on skewed tables.
+    uint64_t low = 0;
+    uint64_t high = header->count;   // search [low, high)
+    bool bisect = false;
+    while (high - low > 8) {
+        uint64_t first = narrowKeys[low];
+        uint64_t last = narrowKeys[high - 1];
+        if (target < first || target > last) return false;
+
+        uint64_t guess;
+        if (bisect || last == first) {
+            guess = low + (high - low) / 2;
+        } else {
+            double fraction = (double)(target - first) / (double)(last - first);
+            guess = low + (uint64_t)(fraction * (double)(high - 1 - low));
+        }
+
+        uint64_t before = high - low;
+        if (narrowKeys[guess] < target) {
+            low = guess + 1;
+        } else if (narrowKeys[guess] > target) {
+            high = guess;
+        } else {
+            found = guess;
+            return true;
+        }
+        bisect = high - low > before / 2;
+    }
+    for (uint64_t i = low; i < high; i++) {
+        if (narrowKeys[i] == target) {
+            found = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DistanceDatabase::lookup(const BoardKey& key, int& distance) const {
+    uint64_t i;
+    if (!findIndex(key, i)) return false;
+    distance = distances[i];
+    return true;
+}
+
+bool DistanceDatabase::bestMove(const Board& board, const BoardState& state, BoardMove& move,
+                                int& distance) const {
+    BoardKey key = packBoardState(board, state);
+    if (!lookup(key, distance)) return false;
+    if (distance == 0 || distance == DISTANCE_DB_UNSOLVABLE) return true;
+
+    std::vector<BoardMove> moves;
+    generateBoardMoves(board, state, moves);
+    for (const BoardMove& candidate : moves) {
+        BoardKey child = key;
+        updateBoardKey(board, child, candidate.car, state[candidate.car], state[candidate.car] + candidate.delta);
+        int childDistance;
+        if (lookup(child, childDistance) && childDistance == distance - 1) {
+            move = candidate;
+            return true;
+        }
+    }
+    // A consistent table always has such a move
+    std::cerr << "Distance database has no improving move from a stored state" << std::endl;
+    return false;
+}
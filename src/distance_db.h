@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "mapped_file.h"
+
+// Precomputed distance-to-win for every state reachable from a level's start.
+//
+// File layout (native endianness, every section 8-byte aligned):
+//   DistanceDbHeader
+//   keys       count x uint64_t (keyWords == 1) or count x BoardKey, ascending
+//   distances  count x uint16_t, same order as the keys
+//
+// The game maps the file and searches it in place, so opening is O(1) in the
+// database size and nothing is parsed or copied.
+
+const uint32_t DISTANCE_DB_MAGIC = 0x42444A50;  // "PJDB"
+const uint32_t DISTANCE_DB_VERSION = 1;
+const int DISTANCE_DB_UNSOLVABLE = 0xFFFF;      // the exit cannot be reached from this state
+const char* const DISTANCE_DB_DIR = "distances";
+
+struct DistanceDbHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fingerprint;   // boardFingerprint of the level it was built for
+    uint64_t count;         // states stored
+    uint32_t keyWords;      // 64-bit words per key
+    uint32_t maxDistance;   // largest finite distance
+    uint32_t startDistance; // distance of the level's start state
+    uint32_t reserved;
+};
+
+struct DistanceDbBuildStats {
+    uint64_t states = 0;
+    uint64_t solvable = 0;   // states with a finite distance
+    int maxDistance = 0;
+    int startDistance = DISTANCE_DB_UNSOLVABLE;
+    double seconds = 0.0;
+    size_t fileBytes = 0;
+};
+
+// "distances/level3.pjdb"
+std::string distanceDatabasePath(const std::string& directory, int levelNumber);
+
+// Enumerates every state reachable from the board's start (without moving past
+// a win), runs a multi-source BFS back from the winning states and writes the
+// sorted table to `path`. Prints the reason to std::cerr and returns false on
+// failure or if more than maxStates states are reachable.
+bool buildDistanceDatabase(const Board& board, const std::string& path, uint64_t maxStates,
+                           DistanceDbBuildStats& stats);
+
+class DistanceDatabase {
+public:
+    DistanceDatabase();
+
+    // Fails (with a message) if the file is malformed or was built for a different board
+    bool open(const std::string& path, const Board& board);
+    void close();
+
+    bool isOpen() const { return header != NULL; }
+    uint64_t size() const { return header ? header->count : 0; }
+    int startDistance() const { return header ? (int)header->startDistance : DISTANCE_DB_UNSOLVABLE; }
+
+    // Slides left to win from `key`, or DISTANCE_DB_UNSOLVABLE; false if the
+    // state is not in the table (it was not reachable from the start)
+    bool lookup(const BoardKey& key, int& distance) const;
+
+    // Distance of `state` plus, if it is finite and non-zero, a move that
+    // reduces it by one. False if the state is not in the table.
+    bool bestMove(const Board& board, const BoardState& state, BoardMove& move, int& distance) const;
+
+private:
+    bool findIndex(const BoardKey& key, uint64_t& index) const;
+
+    MappedFile file;
+    const DistanceDbHeader* header;
+    const uint64_t* narrowKeys;
+    const BoardKey* wideKeys;
+    const uint16_t* distances;
+};
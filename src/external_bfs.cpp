@@ -0,0 +1,410 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <string>
+
+#include "process_stats.h"
+
+namespace {
+
+const size_t WRITE_BUFFER_BYTES = 8 << 20;
+const size_t MIN_READ_BUFFER_BYTES = 256 << 10;
+const size_t MAX_READ_BUFFER_BYTES = 8 << 20;
+
+// Sequential writer of fixed-size records through a large buffer
+template <typename Key>
+class KeyWriter {
+public:
+    KeyWriter() : file(NULL), failed(false), written(0) {}
+    ~KeyWriter() { close(); }
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) std::cerr << "External BFS: cannot create " << path << std::endl;
+        buffer.reserve(WRITE_BUFFER_BYTES / sizeof(Key));
+        return file != NULL;
+    }
+
+    void write(const Key& key) {
+        buffer.push_back(key);
+        written++;
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+
+    // False if any write failed (disk full, ...)
+    bool close() {
+        if (!file) return !failed;
+        flush();
+        if (std::fclose(file) != 0) failed = true;
+        file = NULL;
+        return !failed;
+    }
+
+    uint64_t count() const { return written; }
+
+private:
+    void flush() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), sizeof(Key), buffer.size(), file) != buffer.size()) {
+            failed = true;
+        }
+        buffer.clear();
+    }
+
+    std::FILE* file;
+    std::vector<Key> buffer;
+    bool failed;
+    uint64_t written;
+};
+
+template <typename Key>
+class KeyReader {
+public:
+    KeyReader() : file(NULL), position(0) {}
+    ~KeyReader() { close(); }
+
+    bool open(const std::string& path, size_t bufferBytes) {
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            std::cerr << "External BFS: cannot open " << path << std::endl;
+            return false;
+        }
+        // No bigger than the file: early layers and runs are tiny
+        if (std::fseek(file, 0, SEEK_END) == 0) {
+            long fileBytes = std::ftell(file);
+            if (fileBytes >= 0) bufferBytes = std::min(bufferBytes, (size_t)fileBytes);
+            std::rewind(file);
+        }
+        buffer.reserve(std::max<size_t>(1, bufferBytes / sizeof(Key)));
+        position = 0;
+        return true;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = NULL;
+    }
+
+    bool next(Key& key) {
+        if (position == buffer.size()) {
+            if (!file) return false;
+            buffer.resize(buffer.capacity());
+            buffer.resize(std::fread(buffer.data(), sizeof(Key), buffer.size(), file));
+            position = 0;
+            if (buffer.empty()) return false;
+        }
+        key = buffer[position++];
+        return true;
+    }
+
+    // Refills resize to the whole capacity, so that much is touched once read
+    size_t bytes() const { return buffer.capacity() * sizeof(Key); }
+
+private:
+    std::FILE* file;
+    std::vector<Key> buffer;
+    size_t position;
+};
+
+// Read side of a sorted file that only moves forward: contains() must be
+// called with non-decreasing keys
+template <typename Key>
+class SortedFileFilter {
+public:
+    SortedFileFilter() : active(false), valid(false) {}
+
+    bool open(const std::string& path, size_t bufferBytes) {
+        active = true;
+        if (!reader.open(path, bufferBytes)) return false;
+        valid = reader.next(current);
+        return true;
+    }
+
+    bool contains(const Key& key) {
+        if (!active) return false;
+        while (valid && current < key) valid = reader.next(current);
+        return valid && current == key;
+    }
+
+    size_t bytes() const { return reader.bytes(); }
+
+private:
+    KeyReader<Key> reader;
+    Key current;
+    bool active;
+    bool valid;
+};
+
+template <typename Key>
+struct ExternalBfs {
+    const Board& board;
+    const SolveOptions& options;
+    SolveResult& result;
+    std::string prefix;
+    std::vector<std::string> files;     // everything created, removed at the end
+    int layerCount;
+
+    ExternalBfs(const Board& board, const SolveOptions& options, SolveResult& result)
+        : board(board), options(options), result(result), layerCount(0) {
+        std::stringstream ss;
+        ss << options.scratchDirectory << "/pjbfs-" << (uint64_t)(monotonicSeconds() * 1e6);
+        prefix = ss.str();
+    }
+
+    ~ExternalBfs() {
+        for (const std::string& path : files) std::remove(path.c_str());
+    }
+
+    std::string layerPath(int depth) const {
+        std::stringstream ss;
+        ss << prefix << "-layer" << depth << ".bin";
+        return ss.str();
+    }
+
+    std::string runPath(int run) const {
+        std::stringstream ss;
+        ss << prefix << "-run" << run << ".bin";
+        return ss.str();
+    }
+
+    // stats.tableBytes: the most a single expand or merge pass held in memory
+    void noteMemory(size_t bytes) {
+        result.stats.tableBytes = std::max(result.stats.tableBytes, bytes);
+    }
+
+    bool spill(std::vector<Key>& buffer, std::vector<std::string>& runs) {
+        std::sort(buffer.begin(), buffer.end());
+        std::string path = runPath((int)runs.size());
+        files.push_back(path);
+        runs.push_back(path);
+
+        KeyWriter<Key> writer;
+        if (!writer.open(path)) return false;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            if (i > 0 && buffer[i] == buffer[i - 1]) continue;
+            writer.write(buffer[i]);
+        }
+        buffer.clear();
+        return writer.close();
+    }
+
+    // Expands layer `depth` into sorted runs of children (with duplicates)
+    bool expand(int depth, std::vector<std::string>& runs) {
+        KeyReader<Key> layer;
+        if (!layer.open(layerPath(depth), MAX_READ_BUFFER_BYTES)) return false;
+
+        // Only the part of the reserve that children actually fill is counted
+        std::vector<Key> buffer;
+        buffer.reserve(std::max<size_t>(1, options.memoryBytes / sizeof(Key)));
+        size_t filled = 0;
+
+        BoardState state;
+        std::vector<BoardMove> moves;
+        Key key;
+        while (layer.next(key)) {
+            BoardKey parent = BoardKeyCodec<Key>::decode(key);
+            unpackBoardState(board, parent, state);
+            generateBoardMoves(board, state, moves);
+            result.stats.expanded++;
+
+            for (const BoardMove& move : moves) {
+                BoardKey child = parent;
+                updateBoardKey(board, child, move.car, state[move.car], state[move.car] + move.delta);
+                buffer.push_back(BoardKeyCodec<Key>::encode(child));
+                if (buffer.size() == buffer.capacity()) {
+                    filled = buffer.size();
+                    if (!spill(buffer, runs)) return false;
+                }
+            }
+        }
+        filled = std::max(filled, buffer.size());
+        noteMemory(filled * sizeof(Key) + layer.bytes());
+        return buffer.empty() || spill(buffer, runs);
+    }
+
+    // Merges the runs into layer depth + 1, dropping keys already in layers
+    // depth and depth - 1. Sets `goal` if a winning state shows up.
+    bool merge(int depth, const std::vector<std::string>& runs, uint64_t& written, bool& found, Key& goal) {
+        // Share the memory budget between the run readers, within sane limits
+        size_t readBytes = options.memoryBytes / (runs.size() + 2);
+        readBytes = std::max(MIN_READ_BUFFER_BYTES, std::min(MAX_READ_BUFFER_BYTES, readBytes));
+
+        std::vector<KeyReader<Key>> readers(runs.size());
+        typedef std::pair<Key, size_t> HeapEntry;
+        auto later = [](const HeapEntry& a, const HeapEntry& b) { return b.first < a.first; };
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, decltype(later)> heap(later);
+        for (size_t i = 0; i < runs.size(); i++) {
+            if (!readers[i].open(runs[i], readBytes)) return false;
+            Key key;
+            if (readers[i].next(key)) heap.push(HeapEntry(key, i));
+        }
+
+        SortedFileFilter<Key> current;
+        SortedFileFilter<Key> previous;
+        if (!current.open(layerPath(depth), readBytes)) return false;
+        if (depth > 0 && !previous.open(layerPath(depth - 1), readBytes)) return false;
+
+        std::string path = layerPath(depth + 1);
+        files.push_back(path);
+        layerCount = depth + 2;
+        KeyWriter<Key> writer;
+        if (!writer.open(path)) return false;
+
+        BoardState state;
+        bool haveLast = false;
+        Key last;
+        while (!heap.empty()) {
+            HeapEntry top = heap.top();
+            heap.pop();
+            Key key;
+            if (readers[top.second].next(key)) heap.push(HeapEntry(key, top.second));
+
+            if (haveLast && top.first == last) continue;
+            last = top.first;
+            haveLast = true;
+            if (current.contains(top.first) || previous.contains(top.first)) continue;
+
+            writer.write(top.first);
+            if (!found) {
+                unpackBoardState(board, BoardKeyCodec<Key>::decode(top.first), state);
+                if (boardIsSolved(board, state)) {
+                    found = true;
+                    goal = top.first;
+                }
+            }
+        }
+        size_t readerBytes = current.bytes() + previous.bytes();
+        for (const KeyReader<Key>& reader : readers) readerBytes += reader.bytes();
+        noteMemory(readerBytes);
+        written = writer.count();
+        return writer.close();
+    }
+
+    // Walks back from the goal: each step scans one layer file for a neighbour
+    bool recoverPath(Key goal, int goalDepth) {
+        BoardState state;
+        std::vector<BoardMove> moves;
+        std::vector<std::pair<Key, BoardMove>> neighbours;
+        Key key = goal;
+
+        for (int depth = goalDepth - 1; depth >= 0; depth--) {
+            BoardKey child = BoardKeyCodec<Key>::decode(key);
+            unpackBoardState(board, child, state);
+            generateBoardMoves(board, state, moves);
+            neighbours.clear();
+            for (const BoardMove& move : moves) {
+                BoardKey parent = child;
+                updateBoardKey(board, parent, move.car, state[move.car], state[move.car] + move.delta);
+                // The move that led from that neighbour here is the reverse slide
+                neighbours.push_back(std::make_pair(BoardKeyCodec<Key>::encode(parent),
+                                                    BoardMove{move.car, (int16_t)-move.delta}));
+            }
+            std::sort(neighbours.begin(), neighbours.end(),
+                      [](const std::pair<Key, BoardMove>& a, const std::pair<Key, BoardMove>& b) {
+                          return a.first < b.first;
+                      });
+
+            KeyReader<Key> layer;
+            if (!layer.open(layerPath(depth), MAX_READ_BUFFER_BYTES)) return false;
+            bool stepped = false;
+            Key candidate;
+            while (!stepped && layer.next(candidate)) {
+                auto it = std::lower_bound(neighbours.begin(), neighbours.end(), candidate,
+                                           [](const std::pair<Key, BoardMove>& a, const Key& k) {
+                                               return a.first < k;
+                                           });
+                if (it != neighbours.end() && it->first == candidate) {
+                    result.moves.push_back(it->second);
+                    key = candidate;
+                    stepped = true;
+                }
+            }
+            if (!stepped) {
+                std::cerr << "External BFS: layer " << depth << " has no parent of the path" << std::endl;
+                return false;
+            }
+        }
+        std::reverse(result.moves.begin(), result.moves.end());
+        return true;
+    }
+
+    bool run(const BoardState& start) {
+        Key startKey = BoardKeyCodec<Key>::encode(packBoardState(board, start));
+        {
+            std::string path = layerPath(0);
+            files.push_back(path);
+            layerCount = 1;
+            KeyWriter<Key> writer;
+            if (!writer.open(path)) return false;
+            writer.write(startKey);
+            if (!writer.close()) return false;
+        }
+        result.stats.stored = 1;
+        if (boardIsSolved(board, start)) {
+            result.solved = true;
+            return true;
+        }
+
+        for (int depth = 0;; depth++) {
+            std::vector<std::string> runs;
+            if (!expand(depth, runs)) return false;
+
+            uint64_t written = 0;
+            bool found = false;
+            Key goal;
+            bool ok = merge(depth, runs, written, found, goal);
+            for (const std::string& path : runs) std::remove(path.c_str());
+            if (!ok) {
+                std::cerr << "External BFS: writing layer " << (depth + 1) << " failed" << std::endl;
+                return false;
+            }
+            result.stats.stored += written;
+
+            if (found) {
+                result.solved = true;
+                return recoverPath(goal, depth + 1);
+            }
+            if (written == 0) return true;
+            if (result.stats.stored >= options.maxStates ||
+                (options.cancel && options.cancel->load(std::memory_order_relaxed))) {
+                result.aborted = true;
+                return true;
+            }
+        }
+    }
+};
+
+} // namespace
+
+bool solveExternalBfs(const Board& board, const BoardState& initial, const SolveOptions& options, SolveResult& result) {
+    result = SolveResult();
+    double startTime = monotonicSeconds();
+
+    // The visited set only ever sees canonical states (see canonicalizeBoardState)
+    BoardState start = initial;
+    std::vector<int> labels;
+    canonicalizeBoardState(board, start, &labels);
+
+    if (board.keyBits > BOARD_KEY_BITS) {
+        std::cerr << "Solver: board needs " << board.keyBits << " key bits (max " << BOARD_KEY_BITS << ")" << std::endl;
+        return false;
+    }
+
+    // Layer files hold 8-byte keys when the board packs into 64 bits
+    bool ok;
+    if (board.keyBits <= 64) {
+        ExternalBfs<uint64_t> search(board, options, result);
+        ok = search.run(start);
+    } else {
+        ExternalBfs<BoardKey> search(board, options, result);
+        ok = search.run(start);
+    }
+
+    relabelBoardMoves(labels, result.moves);
+    result.stats.seconds = monotonicSeconds() - startTime;
+    result.stats.peakRssBytes = peakResidentBytes();
+    return ok;
+}
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "level_generator.h"
+#include "level_pack.h"
+
+// Generates solver-verified levels straight into a level pack:
+//   ParkingJamGenerator OUT.pjlp [--count N] [--lot COLUMNSxROWS] [--cell S]
+//                       [--cars MIN-MAX] [--walls N] [--moves MIN-MAX]
+//                       [--time SECONDS] [--threads N] [--seed N] [--max-states N] [--no-solve]
+// --no-solve skips the solver, for stress lots such as --lot 200x200 --cars 10000-10000
+static bool parseRange(const char* text, char separator, int& low, int& high) {
+    char expected = 0;
+    return std::sscanf(text, "%d%c%d", &low, &expected, &high) == 3 && expected == separator && low <= high;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    int count = 100;
+    const char* outputPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = true;
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--lot") == 0 && i + 1 < argc) {
+            ok = std::sscanf(argv[++i], "%dx%d", &options.columns, &options.rows) == 2;
+        } else if (std::strcmp(argv[i], "--cell") == 0 && i + 1 < argc) {
+            options.cell = (float)std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--cars") == 0 && i + 1 < argc) {
+            ok = parseRange(argv[++i], '-', options.minCars, options.maxCars);
+        } else if (std::strcmp(argv[i], "--walls") == 0 && i + 1 < argc) {
+            options.walls = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--moves") == 0 && i + 1 < argc) {
+            ok = parseRange(argv[++i], '-', options.minMoves, options.maxMoves) && options.minMoves >= 0;
+        } else if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            options.gameTime = (float)std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--no-solve") == 0) {
+            options.solve = false;
+        } else if (argv[i][0] != '-' && !outputPath) {
+            outputPath = argv[i];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Bad argument " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (!outputPath || count < 1) {
+        std::cerr << "Usage: ParkingJamGenerator OUT.pjlp [--count N] [--lot 6x6] [--cell 2] [--cars 8-12] "
+                     "[--walls N] [--moves 10-40] [--threads N] [--seed N] [--no-solve]" << std::endl;
+        return 1;
+    }
+
+    LevelPackWriter writer;
+    if (!writer.open(outputPath)) return 1;
+
+    std::vector<int> lengthCounts(options.maxMoves + 1, 0);
+    GeneratorStats stats;
+    bool ok = generateLevels(options, count, [&](const LevelSetup& level, int moves) {
+        lengthCounts[moves]++;
+        return writer.add(level);
+    }, stats);
+    if (!ok || !writer.finish()) return 1;
+
+    std::cout << "Wrote " << writer.size() << " levels to " << outputPath << std::endl;
+    std::cout << "  candidates " << stats.candidates << ": " << stats.accepted << " accepted, "
+              << stats.unsolvable << " unsolvable, " << stats.outOfBand << " outside " << options.minMoves << "-"
+              << options.maxMoves << " moves, " << stats.duplicates << " duplicates ("
+              << stats.overlaps << " overlapping placements retried)" << std::endl;
+    std::cout << "  optimal lengths:";
+    for (int moves = options.minMoves; moves <= options.maxMoves; moves++) {
+        if (lengthCounts[moves] > 0) std::cout << " " << moves << ":" << lengthCounts[moves];
+    }
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(2) << "  " << stats.seconds << " s, "
+              << stats.acceptedPerSecond() << " levels accepted per second" << std::endl;
+    return 0;
+}
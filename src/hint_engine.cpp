@@ -0,0 +1,136 @@
+#include "hint_engine.h"
+
+#include "distance_db.h"
+#include "solver.h"
+
+HintEngine::HintEngine()
+    : cancelFlag(false), stopping(false), database(NULL), boardGeneration(0),
+      jobPending(false), jobRunning(false), jobHash(0), hasUnanswered(false), unansweredHash(0), solver(32),
+      solverGeneration(0) {
+    worker = std::thread(&HintEngine::run, this);
+}
+
+HintEngine::~HintEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        cancelFlag = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void HintEngine::setBoard(const Board& newBoard, const DistanceDatabase* newDatabase) {
+    std::lock_guard<std::mutex> lock(mutex);
+    board = newBoard;
+    database = newDatabase;
+    buildZobristTable(board, zobrist);
+    boardGeneration++;
+    cache.clear();
+    hasUnanswered = false;
+    jobPending = false;
+    cancelFlag = true;
+}
+
+void HintEngine::request(const BoardState& state, uint64_t hash) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cache.count(hash)) return;
+
+        BoardMove move;
+        int distance;
+        if (database && database->bestMove(board, state, move, distance)) {
+            if (distance == DISTANCE_DB_UNSOLVABLE) {
+                cache[hash] = {false, -1, 0, 0};
+            } else if (distance == 0) {
+                cache[hash] = {true, -1, 0, 0};
+            } else {
+                cache[hash] = {true, move.car, move.delta, distance};
+            }
+            return;
+        }
+
+        if ((jobPending || jobRunning) && jobHash == hash) return;
+        if (jobRunning) cancelFlag = true;
+        jobState = state;
+        jobHash = hash;
+        jobPending = true;
+    }
+    wake.notify_one();
+}
+
+void HintEngine::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobPending = false;
+    if (jobRunning) cancelFlag = true;
+}
+
+HintEngine::Status HintEngine::poll(uint64_t hash, Hint& hint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(hash);
+    if (it != cache.end()) {
+        hint = it->second;
+        return READY;
+    }
+    if ((jobPending || jobRunning) && jobHash == hash) return THINKING;
+    if (hasUnanswered && unansweredHash == hash) return NO_HINT;
+    return IDLE;
+}
+
+void HintEngine::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || jobPending; });
+        if (stopping) return;
+
+        // Snapshot the job so the render thread can queue the next one meanwhile
+        Board jobBoard = board;
+        ZobristTable jobZobrist = zobrist;
+        BoardState state = jobState;
+        uint64_t hash = jobHash;
+        uint64_t generation = boardGeneration;
+        jobPending = false;
+        jobRunning = true;
+        cancelFlag = false;
+        lock.unlock();
+
+        if (solverGeneration != generation) {
+            solver.reset(jobBoard);
+            solverGeneration = generation;
+        }
+        SolveOptions options;
+        options.cancel = &cancelFlag;
+        SolveResult result;
+        ResolveStats reuse;
+        bool ok = boardStateValid(jobBoard, state) && solver.solve(state, options, result, reuse);
+
+        lock.lock();
+        jobRunning = false;
+        if (generation != boardGeneration || result.aborted) continue;
+
+        // A state off the lattice (cars rounded onto overlapping slots) or a
+        // failed search proves nothing; only a finished search is cached
+        if (!ok) {
+            unansweredHash = hash;
+            hasUnanswered = true;
+            continue;
+        }
+        if (!result.solved) {
+            cache[hash] = {false, -1, 0, 0};
+            continue;
+        }
+        if (result.moves.empty()) {
+            cache[hash] = {true, -1, 0, 0};
+            continue;
+        }
+
+        // Every state on the optimal line gets the next move of that line
+        int movesLeft = (int)result.moves.size();
+        for (const BoardMove& move : result.moves) {
+            cache[hash] = {true, move.car, move.delta, movesLeft--};
+            int from = state[move.car];
+            applyBoardMove(state, move);
+            hash = zobristMove(jobZobrist, hash, move.car, from, state[move.car]);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "board.h"
+#include "incremental_solver.h"
+
+class DistanceDatabase;
+
+struct Hint {
+    bool solvable;
+    int car;            // index into cars / Board::cars
+    int delta;          // slots; sign gives the direction
+    int movesLeft;      // optimal slides from the hinted state
+};
+
+// Runs the solver on a background thread so the render loop never waits on
+// it. Results are cached by Zobrist hash, and every state along a solution
+// gets its own entry, so following a hint makes the next one instant.
+// States found in the level's distance database are answered on the spot.
+// The worker's IncrementalSolver keeps its distances and table across
+// requests, so a hint after a player move re-roots the previous search.
+class HintEngine {
+public:
+    // NO_HINT: the search for this state ended without an answer (the state is
+    // not on the solver's lattice); nothing is cached, a new request retries
+    enum Status { IDLE, THINKING, READY, NO_HINT };
+
+    HintEngine();
+    ~HintEngine();
+
+    // New level: drops the cache and any running search. `database` (optional,
+    // must outlive the board) answers requests without searching.
+    void setBoard(const Board& board, const DistanceDatabase* database = NULL);
+
+    // Starts a search for `state` unless it is cached or already running
+    void request(const BoardState& state, uint64_t hash);
+
+    // Stops the running search (the player moved away from its state)
+    void cancel();
+
+    Status poll(uint64_t hash, Hint& hint);
+
+private:
+    void run();
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> cancelFlag;
+    bool stopping;
+
+    Board board;
+    ZobristTable zobrist;
+    const DistanceDatabase* database;
+    uint64_t boardGeneration;
+
+    bool jobPending;
+    bool jobRunning;
+    BoardState jobState;
+    uint64_t jobHash;
+
+    std::unordered_map<uint64_t, Hint> cache;
+    bool hasUnanswered;
+    uint64_t unansweredHash;    // last state whose search gave no answer
+
+    // Worker thread only
+    IncrementalSolver solver;
+    uint64_t solverGeneration;
+};
@@ -0,0 +1,95 @@
+#include "incremental_solver.h"
+
+#include <algorithm>
+
+#include "process_stats.h"
+
+IncrementalSolver::IncrementalSolver(size_t tableMegabytes) : table(tableMegabytes), coldExpanded(0) {}
+
+void IncrementalSolver::reset(const Board& newBoard) {
+    board = newBoard;
+    buildZobristTable(board, zobrist);
+    table.clear();
+    known.clear();
+    coldExpanded = 0;
+}
+
+void IncrementalSolver::learnLine(BoardState state, uint64_t hash, const std::vector<BoardMove>& moves) {
+    // Suffixes of an optimal line are optimal, so every state on it gets an exact distance
+    int distance = (int)moves.size();
+    for (const BoardMove& move : moves) {
+        known[hash] = {distance--, move};
+        int from = state[move.car];
+        applyBoardMove(state, move);
+        hash = zobristMove(zobrist, hash, move.car, from, state[move.car]);
+    }
+    known[hash] = {0, {0, 0}};
+}
+
+void IncrementalSolver::followKnown(BoardState state, uint64_t hash, SolveResult& result) const {
+    auto it = known.find(hash);
+    while (it != known.end() && it->second.distance > 0) {
+        BoardMove move = it->second.next;
+        int from = state[move.car];
+        applyBoardMove(state, move);
+        hash = zobristMove(zobrist, hash, move.car, from, state[move.car]);
+        result.moves.push_back(move);
+        it = known.find(hash);
+    }
+    result.solved = true;
+}
+
+bool IncrementalSolver::solve(const BoardState& state, const SolveOptions& options, SolveResult& result,
+                              ResolveStats& reuse) {
+    result = SolveResult();
+    reuse = ResolveStats();
+    double startTime = monotonicSeconds();
+    uint64_t hash = zobristHash(zobrist, state);
+
+    if (!known.count(hash) && !boardIsSolved(board, state)) {
+        // Bounds from neighbours with known distances: one slide changes the distance by at most one
+        std::vector<BoardMove> moves;
+        generateBoardMoves(board, state, moves);
+        int lower = 0;
+        int upper = BOARD_DEAD_END;
+        BoardMove best = {0, 0};
+        for (const BoardMove& move : moves) {
+            uint64_t child = zobristMove(zobrist, hash, move.car, state[move.car], state[move.car] + move.delta);
+            auto it = known.find(child);
+            if (it == known.end()) continue;
+            lower = std::max(lower, it->second.distance - 1);
+            if (it->second.distance + 1 < upper) {
+                upper = it->second.distance + 1;
+                best = move;
+            }
+        }
+        if (upper < BOARD_DEAD_END && lower == upper) {
+            known[hash] = {upper, best};
+        } else if (lower > 0) {
+            // The search probes its root under the plain hash (no car moved yet)
+            table.store(hash, lower, 0, TT_LOWER);
+        }
+    }
+
+    if (known.count(hash) || boardIsSolved(board, state)) {
+        followKnown(state, hash, result);
+        reuse.fromKnown = true;
+        reuse.coldExpanded = coldExpanded;
+        result.stats.seconds = monotonicSeconds() - startTime;
+        return true;
+    }
+
+    SolveOptions searchOptions = options;
+    searchOptions.table = &table;
+    table.newGeneration();
+    uint64_t hitsBefore = table.stats().hits;
+    if (!solveIdaStar(board, state, searchOptions, result)) return false;
+
+    reuse.expanded = result.stats.expanded;
+    reuse.tableHits = table.stats().hits - hitsBefore;
+    if (coldExpanded == 0 && !result.aborted) coldExpanded = std::max<uint64_t>(1, result.stats.expanded);
+    reuse.coldExpanded = coldExpanded;
+
+    if (result.solved) learnLine(state, hash, result.moves);
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "board.h"
+#include "solver.h"
+#include "transposition_table.h"
+
+struct ResolveStats {
+    bool fromKnown = false;      // answered from stored distances, no search ran
+    uint64_t expanded = 0;
+    uint64_t tableHits = 0;      // table probes that found a bound from earlier work
+    uint64_t coldExpanded = 0;   // first search on this board, which had nothing to reuse
+
+    double savedFraction() const {
+        if (coldExpanded == 0) return 0.0;
+        return expanded >= coldExpanded ? 0.0 : 1.0 - (double)expanded / coldExpanded;
+    }
+};
+
+// Solves one board over and over from wherever the player is now, keeping
+// what earlier solves learned:
+//   - the exact distance and next move of every state on a returned solution
+//   - the IDA* transposition table (exact distances and lower bounds)
+// Each solve() re-roots at the given state. States on a known line are
+// answered without searching; a state next to known ones gets the bounds
+// d(neighbour) - 1 <= d <= d(neighbour) + 1, which settle it outright when
+// they meet and otherwise seed the search's table.
+class IncrementalSolver {
+public:
+    explicit IncrementalSolver(size_t tableMegabytes = 64);
+
+    // Forgets everything; call once per level
+    void reset(const Board& board);
+
+    bool solve(const BoardState& state, const SolveOptions& options, SolveResult& result, ResolveStats& reuse);
+
+    size_t knownStates() const { return known.size(); }
+
+private:
+    struct Known {
+        int distance;
+        BoardMove next;     // unused when distance == 0
+    };
+
+    void learnLine(BoardState state, uint64_t hash, const std::vector<BoardMove>& moves);
+    void followKnown(BoardState state, uint64_t hash, SolveResult& result) const;
+
+    Board board;
+    ZobristTable zobrist;
+    TranspositionTable table;
+    std::unordered_map<uint64_t, Known> known;
+    uint64_t coldExpanded;
+};
@@ -0,0 +1,177 @@
+#include "input_latency.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() : buckets(BUCKETS, 0), total(0), sum(0.0), maxSeconds(0.0) {}
+
+void LatencyHistogram::add(double seconds) {
+    if (seconds < 0.0) seconds = 0.0;
+    int bucket = (int)(seconds / BUCKET_WIDTH);
+    if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+    buckets[bucket]++;
+    total++;
+    sum += seconds;
+    maxSeconds = std::max(maxSeconds, seconds);
+}
+
+void LatencyHistogram::clear() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    total = 0;
+    sum = 0.0;
+    maxSeconds = 0.0;
+}
+
+double LatencyHistogram::mean() const {
+    return total ? sum / total : 0.0;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0.0;
+    uint64_t rank = (uint64_t)(p * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Report the bucket's upper edge, capped by the largest sample seen
+            return std::min((i + 1) * BUCKET_WIDTH, maxSeconds);
+        }
+    }
+    return maxSeconds;
+}
+
+InputLatencyTracker::InputLatencyTracker()
+    : nextId(0), gpuQueries(false), gpuAtCalibration(0), cpuAtCalibration(0.0), dropped(0) {}
+
+void InputLatencyTracker::init() {
+    frames.resize(QUERY_POOL);
+    for (auto& frame : frames) {
+        glGenQueries(1, &frame.query);
+        frame.inFlight = false;
+    }
+    gpuQueries = glGetError() == GL_NO_ERROR;
+}
+
+void InputLatencyTracker::shutdown() {
+    for (auto& frame : frames) {
+        glDeleteQueries(1, &frame.query);
+    }
+    frames.clear();
+    gpuQueries = false;
+}
+
+void InputLatencyTracker::calibrate(double now) {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuAtCalibration = gpuNow;
+    cpuAtCalibration = now;
+}
+
+void InputLatencyTracker::onInput(int key, double now) {
+    pending.push_back({nextId++, key, PRESSED, now, 0.0, 0.0});
+}
+
+void InputLatencyTracker::onSimulated(double now) {
+    for (auto& e : pending) {
+        if (e.stage == PRESSED) {
+            e.stage = SIMULATED;
+            e.simTime = now;
+        }
+    }
+}
+
+void InputLatencyTracker::onSubmit(double now) {
+    for (auto& e : pending) {
+        if (e.stage == SIMULATED) {
+            e.stage = SUBMITTED;
+            e.submitTime = now;
+        }
+    }
+}
+
+void InputLatencyTracker::onSwapped(double now) {
+    std::vector<Event> submitted;
+    std::vector<Event> waiting;
+    for (const auto& e : pending) {
+        if (e.stage == SUBMITTED) {
+            submitted.push_back(e);
+        } else if (now - e.pressTime > EVENT_TIMEOUT) {
+            // Never produced a visible change (blocked move, key released early, ...)
+            dropped++;
+        } else {
+            waiting.push_back(e);
+        }
+    }
+    pending.swap(waiting);
+    if (submitted.empty()) return;
+
+    if (gpuQueries) {
+        for (auto& frame : frames) {
+            if (frame.inFlight) continue;
+            if (cpuAtCalibration == 0.0 || now - cpuAtCalibration > 2.0) calibrate(now);
+            glQueryCounter(frame.query, GL_TIMESTAMP);
+            frame.inFlight = true;
+            frame.events.swap(submitted);
+            return;
+        }
+    }
+
+    // No timer query available: the swap returning is the best completion time we have
+    for (const auto& e : submitted) {
+        complete(e, now);
+    }
+}
+
+void InputLatencyTracker::poll() {
+    for (auto& frame : frames) {
+        if (!frame.inFlight) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 gpuTime = 0;
+        glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpuTime);
+        double presentTime = cpuAtCalibration + (double)((int64_t)gpuTime - gpuAtCalibration) * 1e-9;
+        for (const auto& e : frame.events) {
+            // Clock drift can put the GPU time before submit; never report negative stages
+            complete(e, std::max(presentTime, e.submitTime));
+        }
+        frame.events.clear();
+        frame.inFlight = false;
+    }
+}
+
+void InputLatencyTracker::complete(const Event& e, double presentTime) {
+    endToEnd.add(presentTime - e.pressTime);
+    pressToSim.add(e.simTime - e.pressTime);
+    simToSubmit.add(e.submitTime - e.simTime);
+    submitToPresent.add(presentTime - e.submitTime);
+}
+
+void InputLatencyTracker::reset() {
+    endToEnd.clear();
+    pressToSim.clear();
+    simToSubmit.clear();
+    submitToPresent.clear();
+    dropped = 0;
+}
+
+static void printHistogram(std::ostream& out, const char* name, const LatencyHistogram& h) {
+    out << "  " << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+        << " p50 " << std::setw(7) << h.percentile(0.50) * 1000.0
+        << " p95 " << std::setw(7) << h.percentile(0.95) * 1000.0
+        << " p99 " << std::setw(7) << h.percentile(0.99) * 1000.0
+        << " max " << std::setw(7) << h.max() * 1000.0
+        << " mean " << std::setw(7) << h.mean() * 1000.0 << " ms" << std::endl;
+}
+
+void InputLatencyTracker::dumpStats(std::ostream& out) const {
+    out << "=== INPUT LATENCY (" << endToEnd.count() << " events, " << dropped << " dropped, "
+        << (gpuQueries ? "GPU timestamps" : "CPU swap time") << ") ===" << std::endl;
+    printHistogram(out, "press->present", endToEnd);
+    printHistogram(out, "press->simulate", pressToSim);
+    printHistogram(out, "simulate->submit", simToSubmit);
+    printHistogram(out, "submit->present", submitToPresent);
+}
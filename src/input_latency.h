@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Fixed-bucket latency histogram (0.25 ms buckets, last bucket collects overflow)
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void add(double seconds);
+    void clear();
+
+    uint64_t count() const { return total; }
+    double mean() const;
+    double percentile(double p) const;   // p in [0, 1], result in seconds
+    double max() const { return maxSeconds; }
+
+private:
+    static constexpr int BUCKETS = 2000;
+    static constexpr double BUCKET_WIDTH = 0.00025;
+
+    std::vector<uint64_t> buckets;
+    uint64_t total;
+    double sum;
+    double maxSeconds;
+};
+
+// Tracks key presses from key_callback until the frame that shows their effect
+// has finished on the GPU. Times are glfwGetTime() seconds.
+//
+//   press -> simulated (processInput applied it) -> submitted (before swap)
+//         -> presented (GL_TIMESTAMP query issued after glfwSwapBuffers)
+class InputLatencyTracker {
+public:
+    InputLatencyTracker();
+
+    // Needs a current GL context. Without timer queries, or when all QUERY_POOL
+    // queries are in flight, events complete at the CPU time the swap returned.
+    void init();
+    void shutdown();
+
+    void onInput(int key, double now);
+    void onSimulated(double now);
+    void onSubmit(double now);
+    void onSwapped(double now);
+    void poll();
+
+    void dumpStats(std::ostream& out) const;
+    void reset();
+
+private:
+    enum Stage { PRESSED, SIMULATED, SUBMITTED };
+
+    struct Event {
+        uint32_t id;
+        int key;
+        Stage stage;
+        double pressTime;
+        double simTime;
+        double submitTime;
+    };
+
+    struct FrameQuery {
+        unsigned int query;
+        bool inFlight;
+        std::vector<Event> events;
+    };
+
+    static constexpr int QUERY_POOL = 8;
+    static constexpr double EVENT_TIMEOUT = 1.0;
+
+    void calibrate(double now);
+    void complete(const Event& e, double presentTime);
+
+    std::vector<Event> pending;
+    std::vector<FrameQuery> frames;
+    uint32_t nextId;
+    bool gpuQueries;
+
+    // GPU clock (ns) at cpuAtCalibration, used to map query results to glfwGetTime()
+    int64_t gpuAtCalibration;
+    double cpuAtCalibration;
+
+    LatencyHistogram endToEnd;
+    LatencyHistogram pressToSim;
+    LatencyHistogram simToSubmit;
+    LatencyHistogram submitToPresent;
+    uint64_t dropped;
+};
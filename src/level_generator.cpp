@@ -0,0 +1,190 @@
+#include "level_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "board.h"
+#include "process_stats.h"
+#include "solver.h"
+
+static const int PLACEMENT_TRIES = 50;  // per car, before the car is given up on
+
+// Marks `length` cells from (row, column) as taken if they are all free
+static bool placeRun(const GeneratorOptions& options, std::vector<bool>& taken, int row, int column, int length,
+                     bool vertical) {
+    for (int k = 0; k < length; k++) {
+        if (taken[(vertical ? row + k : row) * options.columns + (vertical ? column : column + k)]) return false;
+    }
+    for (int k = 0; k < length; k++) {
+        taken[(vertical ? row + k : row) * options.columns + (vertical ? column : column + k)] = true;
+    }
+    return true;
+}
+
+bool generateLevelCandidate(const GeneratorOptions& options, std::mt19937_64& rng, LevelSetup& level,
+                            GeneratorStats& stats) {
+    std::vector<bool> taken((size_t)options.rows * options.columns, false);
+    int targetRow = options.rows / 2 - 1;
+    if (targetRow < 0 || options.columns < 3) return false;
+
+    level.gameTime = options.gameTime;
+    level.score = options.score;
+    level.slotSize = options.cell;
+    level.lot = gridLot(options.columns, options.rows, options.cell);
+    level.cars.clear();
+    level.ramps.clear();
+
+    int targetColumn = (int)(rng() % (options.columns / 2));
+    placeRun(options, taken, targetRow, targetColumn, 2, false);
+    level.cars.push_back(gridCar(level.lot, targetRow, targetColumn, 2, false, true, 0));
+    placeGridExit(level.lot, level.cars.back());
+
+    std::vector<int> wallCells;
+    for (int w = 0; w < options.walls; w++) {
+        for (int attempt = 0; attempt < PLACEMENT_TRIES; attempt++) {
+            // Column before row: changing the draw order changes every seed's levels
+            int column = (int)(rng() % options.columns);
+            int row = (int)(rng() % options.rows);
+            if (placeRun(options, taken, row, column, 1, false)) {
+                wallCells.push_back(row * options.columns + column);
+                break;
+            }
+            stats.overlaps++;
+        }
+    }
+
+    int carCount = options.minCars + (int)(rng() % (options.maxCars - options.minCars + 1));
+    for (int c = 0; c < carCount; c++) {
+        for (int attempt = 0; attempt < PLACEMENT_TRIES; attempt++) {
+            bool vertical = rng() & 1;
+            int length = rng() % 4 == 0 ? 3 : 2;
+            // A two-row (or two-column) lot has no room for a truck across it
+            if (length > (vertical ? options.rows : options.columns)) continue;
+            int row = (int)(rng() % (vertical ? options.rows - length + 1 : options.rows));
+            int column = (int)(rng() % (vertical ? options.columns : options.columns - length + 1));
+            // A horizontal car in the target's row could never get out of its way
+            if (!vertical && row == targetRow) continue;
+            if (placeRun(options, taken, row, column, length, vertical)) {
+                level.cars.push_back(gridCar(level.lot, row, column, length, vertical, false,
+                                             (int)level.cars.size() - 1));
+                break;
+            }
+            stats.overlaps++;
+        }
+    }
+
+    // Walls go last, in reading order, as a grid level lists them
+    std::sort(wallCells.begin(), wallCells.end());
+    for (int cell : wallCells) {
+        level.cars.push_back(gridWall(level.lot, cell / options.columns, cell % options.columns));
+    }
+    for (size_t i = 0; i < level.cars.size(); i++) level.cars[i].id = (int)i;
+    return true;
+}
+
+// One candidate's outcome, kept until every earlier candidate is committed
+struct GeneratedCandidate {
+    GeneratorStats counts;           // this candidate's overlaps and rejection
+    bool viable = false;
+    LevelSetup level;
+    int moves = 0;
+    uint64_t fingerprint = 0;
+};
+
+static void addCandidateCounts(GeneratorStats& stats, const GeneratorStats& counts) {
+    stats.candidates++;
+    stats.overlaps += counts.overlaps;
+    stats.unsolvable += counts.unsolvable;
+    stats.outOfBand += counts.outOfBand;
+}
+
+bool generateLevels(const GeneratorOptions& options, int count, const GeneratedLevelSink& accept,
+                    GeneratorStats& stats) {
+    stats = GeneratorStats();
+    double startTime = monotonicSeconds();
+    if (options.minCars < 0 || options.maxCars < options.minCars || options.rows < 2 || options.columns < 3) {
+        std::cerr << "Generator: bad lot or car range" << std::endl;
+        return false;
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+
+    std::mutex lock;                           // guards stats, seen, pending, nextCommit and accept
+    std::unordered_set<uint64_t> seen;         // canonical fingerprints of accepted levels
+    std::map<uint64_t, GeneratedCandidate> pending;
+    uint64_t nextCommit = 0;
+    std::atomic<uint64_t> nextIndex(0);
+    std::atomic<int> accepted(0);
+    std::atomic<bool> failed(false);
+
+    auto work = [&]() {
+        Board board;
+        SolveOptions solveOptions;
+        solveOptions.maxStates = options.maxStates;
+
+        while (accepted.load() < count && !failed.load()) {
+            uint64_t index = nextIndex++;
+            std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ULL + index);
+            GeneratedCandidate candidate;
+
+            if (!generateLevelCandidate(options, rng, candidate.level, candidate.counts)) {
+                candidate.counts.unsolvable++;
+            } else if (!options.solve) {
+                // Stress layouts: any placement will do, nothing is searched or deduplicated
+                candidate.viable = true;
+            } else if (!buildBoard(candidate.level, board)) {
+                candidate.counts.unsolvable++;
+            } else {
+                SolveResult result;
+                if (!solveBfs(board, boardStartState(board), solveOptions, result) || !result.solved) {
+                    candidate.counts.unsolvable++;
+                } else {
+                    candidate.moves = (int)result.moves.size();
+                    if (candidate.moves < options.minMoves || candidate.moves > options.maxMoves) {
+                        candidate.counts.outOfBand++;
+                    } else {
+                        candidate.viable = true;
+                        candidate.fingerprint = boardCanonicalFingerprint(board);
+                    }
+                }
+            }
+
+            // Commit in index order, so a seed gives the same pack whatever the thread count
+            std::lock_guard<std::mutex> guard(lock);
+            pending[index] = std::move(candidate);
+            while (!pending.empty() && pending.begin()->first == nextCommit && accepted.load() < count &&
+                   !failed.load()) {
+                GeneratedCandidate& next = pending.begin()->second;
+                addCandidateCounts(stats, next.counts);
+                if (next.viable) {
+                    if (options.solve && !seen.insert(next.fingerprint).second) {
+                        stats.duplicates++;
+                    } else if (!accept(next.level, next.moves)) {
+                        failed = true;
+                    } else {
+                        stats.accepted++;
+                        accepted++;
+                    }
+                }
+                pending.erase(pending.begin());
+                nextCommit++;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++) threads.emplace_back(work);
+    work();
+    for (auto& thread : threads) thread.join();
+
+    stats.seconds = monotonicSeconds() - startTime;
+    return !failed.load();
+}
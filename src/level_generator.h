@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+
+#include "levels.h"
+
+struct GeneratorOptions {
+    int columns = 6;                 // lot size in cells; the exit is on the right edge
+    int rows = 6;
+    float cell = 2.0f;               // world units per cell, also the solver slot size
+    int minCars = 8;                 // cars besides the target
+    int maxCars = 12;
+    int walls = 0;                   // immovable single-cell blocks
+    int minMoves = 10;               // accepted band of optimal solution lengths, in slides
+    int maxMoves = 40;
+    float gameTime = 120.0f;
+    int score = 1000;
+    int threads = 0;                 // 0 = one per hardware thread
+    uint64_t seed = 1;
+    uint64_t maxStates = 2000000;    // per-candidate BFS cap; bigger candidates are rejected
+    bool solve = true;               // false: accept layouts unsolved (stress lots past the solvers' limits)
+};
+
+struct GeneratorStats {
+    uint64_t candidates = 0;
+    uint64_t overlaps = 0;           // car placements rejected for overlapping earlier cars
+    uint64_t unsolvable = 0;         // includes candidates past maxStates
+    uint64_t outOfBand = 0;          // solvable, but the optimal length is outside the band
+    uint64_t duplicates = 0;         // same layout as an accepted level
+    uint64_t accepted = 0;
+    double seconds = 0.0;
+
+    double acceptedPerSecond() const { return seconds > 0.0 ? accepted / seconds : 0.0; }
+};
+
+// One candidate: a target car in the row above the middle and a random number
+// of cars placed at random cells, each placement that overlaps an earlier car
+// retried. The lot is fitted to the grid (gridLot). Returns false if the
+// layout could not be built. Counts overlaps.
+bool generateLevelCandidate(const GeneratorOptions& options, std::mt19937_64& rng, LevelSetup& level,
+                            GeneratorStats& stats);
+
+// Generates `count` levels whose optimal solution (solveBfs) lies in
+// [minMoves, maxMoves], with candidates split across threads (any layout,
+// reported as 0 moves, if options.solve is false). Candidate i draws from
+// its own generator seeded from (seed, i) and candidates are committed in
+// index order, so a seed gives the same levels whatever the thread count.
+// `accept` is called for each new level under a lock, in that order;
+// returning false from it stops the run with a failure.
+typedef std::function<bool(const LevelSetup& level, int moves)> GeneratedLevelSink;
+bool generateLevels(const GeneratorOptions& options, int count, const GeneratedLevelSink& accept,
+                    GeneratorStats& stats);
@@ -0,0 +1,176 @@
+#include "level_pack.h"
+
+#include <cstring>
+#include <iostream>
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// offset + count * recordSize <= fileSize, without letting a corrupt count wrap the product
+static bool fitsInFile(uint64_t offset, uint64_t count, uint64_t recordSize, uint64_t fileSize) {
+    return offset <= fileSize && count <= (fileSize - offset) / recordSize;
+}
+
+LevelPack::LevelPack() : header(NULL), carRecords(NULL), rampRecords(NULL), entries(NULL) {}
+
+bool LevelPack::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+
+    const LevelPackHeader* candidate = (const LevelPackHeader*)file.data();
+    bool valid = file.size() >= sizeof(LevelPackHeader) && candidate->magic == LEVEL_PACK_MAGIC &&
+                 candidate->version == LEVEL_PACK_VERSION && candidate->carBytes == sizeof(PackedCar);
+    if (valid) {
+        valid = candidate->carsOffset % 4 == 0 && candidate->rampsOffset % 4 == 0 &&
+                candidate->indexOffset % 8 == 0 &&
+                fitsInFile(candidate->carsOffset, candidate->carCount, sizeof(PackedCar), file.size()) &&
+                fitsInFile(candidate->rampsOffset, candidate->rampCount, sizeof(PackedRamp), file.size()) &&
+                fitsInFile(candidate->indexOffset, candidate->levelCount, sizeof(LevelPackEntry), file.size());
+    }
+    if (!valid) {
+        std::cerr << path << " is not a version " << LEVEL_PACK_VERSION << " level pack" << std::endl;
+        file.close();
+        return false;
+    }
+
+    header = candidate;
+    carRecords = (const PackedCar*)(file.data() + header->carsOffset);
+    rampRecords = (const PackedRamp*)(file.data() + header->rampsOffset);
+    entries = (const LevelPackEntry*)(file.data() + header->indexOffset);
+    return true;
+}
+
+void LevelPack::close() {
+    file.close();
+    header = NULL;
+    carRecords = NULL;
+    rampRecords = NULL;
+    entries = NULL;
+}
+
+const LevelPackEntry* LevelPack::entry(int index) const {
+    if (!header || index < 0 || index >= (int)header->levelCount) return NULL;
+    const LevelPackEntry* found = entries + index;
+    // Entries are checked on use rather than all at open
+    if (found->firstCar > header->carCount || found->carCount > header->carCount - found->firstCar) return NULL;
+    if (found->firstRamp > header->rampCount || found->rampCount > header->rampCount - found->firstRamp) return NULL;
+    return found;
+}
+
+const PackedCar* LevelPack::cars(const LevelPackEntry& entry) const {
+    return carRecords + entry.firstCar;
+}
+
+bool LevelPack::load(int index, LevelSetup& level) const {
+    const LevelPackEntry* found = entry(index);
+    if (!found) {
+        std::cerr << "Level pack: no level " << (index + 1) << std::endl;
+        return false;
+    }
+    const PackedCar* records = cars(*found);
+    // Anything but 0/1 in a bool byte would be undefined once copied
+    for (uint32_t i = 0; i < found->carCount; i++) {
+        if (records[i].isVertical > 1 || records[i].isTarget > 1) {
+            std::cerr << "Level pack: level " << (index + 1) << " is corrupt" << std::endl;
+            return false;
+        }
+    }
+
+    level.gameTime = found->gameTime;
+    level.score = found->score;
+    level.slotSize = found->slotSize;
+    level.lot.width = found->lot[0];
+    level.lot.depth = found->lot[1];
+    level.lot.cell = found->lot[2];
+    level.lot.exitX = found->lot[3];
+    level.lot.exitZ = found->lot[4];
+    level.lot.exitWidth = found->lot[5];
+    level.cars.resize(found->carCount);
+    if (found->carCount > 0) std::memcpy(static_cast<void*>(level.cars.data()), records, found->carCount * sizeof(PackedCar));
+    level.ramps.resize(found->rampCount);
+    if (found->rampCount > 0) {
+        std::memcpy(level.ramps.data(), rampRecords + found->firstRamp, found->rampCount * sizeof(PackedRamp));
+    }
+    return true;
+}
+
+LevelPackWriter::LevelPackWriter() : carCount(0) {}
+
+bool LevelPackWriter::open(const std::string& outputPath) {
+    path = outputPath;
+    index.clear();
+    ramps.clear();
+    carCount = 0;
+    out.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    // Placeholder; finish() rewrites it once the counts are known
+    LevelPackHeader header = {};
+    out.write((const char*)&header, sizeof(header));
+    return true;
+}
+
+bool LevelPackWriter::add(const LevelSetup& level) {
+    LevelPackEntry entry = {};
+    entry.firstCar = carCount;
+    entry.carCount = (uint32_t)level.cars.size();
+    entry.gameTime = level.gameTime;
+    entry.score = level.score;
+    entry.slotSize = level.slotSize;
+    const LotLayout& lot = level.lot;
+    float layout[6] = {lot.width, lot.depth, lot.cell, lot.exitX, lot.exitZ, lot.exitWidth};
+    std::memcpy(entry.lot, layout, sizeof(layout));
+    entry.firstRamp = (uint32_t)ramps.size();
+    entry.rampCount = (uint32_t)level.ramps.size();
+    for (const Ramp& ramp : level.ramps) ramps.push_back({ramp.floor, ramp.x0, ramp.z0, ramp.x1, ramp.z1});
+
+    for (const Car& car : level.cars) {
+        PackedCar record = {};
+        for (int axis = 0; axis < 3; axis++) {
+            record.position[axis] = car.position[axis];
+            record.size[axis] = car.size[axis];
+            record.color[axis] = car.baseColor[axis];
+        }
+        record.isVertical = car.isVertical ? 1 : 0;
+        record.isTarget = car.isTarget ? 1 : 0;
+        record.id = car.id;
+        record.minPos = car.minPos;
+        record.maxPos = car.maxPos;
+        out.write((const char*)&record, sizeof(record));
+    }
+    carCount += level.cars.size();
+    index.push_back(entry);
+    return (bool)out;
+}
+
+bool LevelPackWriter::finish() {
+    LevelPackHeader header = {};
+    header.magic = LEVEL_PACK_MAGIC;
+    header.version = LEVEL_PACK_VERSION;
+    header.levelCount = (uint32_t)index.size();
+    header.carBytes = sizeof(PackedCar);
+    header.carCount = carCount;
+    header.carsOffset = sizeof(LevelPackHeader);
+
+    uint64_t carsEnd = header.carsOffset + carCount * sizeof(PackedCar);
+    header.rampCount = ramps.size();
+    header.rampsOffset = alignUp(carsEnd);
+    uint64_t rampsEnd = header.rampsOffset + ramps.size() * sizeof(PackedRamp);
+    header.indexOffset = alignUp(rampsEnd);
+    static const char zeros[8] = {};
+    out.write(zeros, (std::streamsize)(header.rampsOffset - carsEnd));
+    if (!ramps.empty()) out.write((const char*)ramps.data(), ramps.size() * sizeof(PackedRamp));
+    out.write(zeros, (std::streamsize)(header.indexOffset - rampsEnd));
+    if (!index.empty()) out.write((const char*)index.data(), index.size() * sizeof(LevelPackEntry));
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    out.close();
+    if (!out) {
+        std::cerr << "Failed writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "car.h"
+#include "levels.h"
+#include "mapped_file.h"
+
+// Many levels in one binary file, mapped and read in place.
+//
+// File layout (native endianness, sections 8-byte aligned):
+//   LevelPackHeader
+//   cars    carCount x PackedCar; each level's cars are contiguous
+//   ramps   rampCount x PackedRamp; each level's ramps are contiguous
+//   index   levelCount x LevelPackEntry, in level order
+//
+// A PackedCar has exactly the in-memory layout of Car, so a level's cars are
+// one memcpy from the mapping into the vector the game plays on. Opening
+// only checks the header, so it costs the same for 3 levels and 100k.
+
+const uint32_t LEVEL_PACK_MAGIC = 0x504C4A50;   // "PJLP"
+const uint32_t LEVEL_PACK_VERSION = 3;     // 2: lot layout per level, 3: ramps
+const char* const LEVEL_PACK_FILE = "levels.pjlp";
+
+struct LevelPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t carBytes;      // sizeof(PackedCar) when written
+    uint64_t carCount;
+    uint64_t carsOffset;
+    uint64_t indexOffset;
+    uint64_t rampCount;
+    uint64_t rampsOffset;
+};
+
+struct LevelPackEntry {
+    uint64_t firstCar;      // index into the cars section
+    uint32_t carCount;
+    float gameTime;
+    int32_t score;
+    float slotSize;
+    float lot[6];           // LotLayout: width, depth, cell, exitX, exitZ, exitWidth
+    uint32_t firstRamp;     // index into the ramps section
+    uint32_t rampCount;
+};
+
+struct PackedCar {
+    float position[3];
+    float size[3];
+    float color[3];
+    uint8_t isVertical;
+    uint8_t isTarget;
+    uint8_t padding[2];
+    int32_t id;
+    float minPos;
+    float maxPos;
+};
+
+// LevelPack::load and setupBuiltinLevel copy PackedCar records straight into Car objects
+static_assert(std::is_trivially_copyable<Car>::value, "Car must be trivially copyable");
+static_assert(sizeof(PackedCar) == sizeof(Car), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, size) == offsetof(Car, size), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, color) == offsetof(Car, baseColor), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, isVertical) == offsetof(Car, isVertical), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, isTarget) == offsetof(Car, isTarget), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, id) == offsetof(Car, id), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, minPos) == offsetof(Car, minPos), "PackedCar must mirror Car");
+static_assert(offsetof(PackedCar, maxPos) == offsetof(Car, maxPos), "PackedCar must mirror Car");
+
+// Mirrors Ramp the way PackedCar mirrors Car
+struct PackedRamp {
+    int32_t floor;
+    float x0, z0, x1, z1;
+};
+
+static_assert(std::is_trivially_copyable<Ramp>::value, "Ramp must be trivially copyable");
+static_assert(sizeof(PackedRamp) == sizeof(Ramp), "PackedRamp must mirror Ramp");
+static_assert(offsetof(PackedRamp, x0) == offsetof(Ramp, x0), "PackedRamp must mirror Ramp");
+static_assert(offsetof(PackedRamp, z1) == offsetof(Ramp, z1), "PackedRamp must mirror Ramp");
+
+class LevelPack {
+public:
+    LevelPack();
+
+    // Fails (with a message) if the file is not a pack of this version
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return header != NULL; }
+    int size() const { return header ? (int)header->levelCount : 0; }
+
+    // Level `index` (0-based) without copying; NULL if out of range or corrupt
+    const LevelPackEntry* entry(int index) const;
+    const PackedCar* cars(const LevelPackEntry& entry) const;
+
+    // Copies level `index` into `level`; false (with a message) on failure
+    bool load(int index, LevelSetup& level) const;
+
+private:
+    MappedFile file;
+    const LevelPackHeader* header;
+    const PackedCar* carRecords;
+    const PackedRamp* rampRecords;
+    const LevelPackEntry* entries;
+};
+
+// Streams levels into a pack: cars are written as levels arrive and the ramps
+// and index go at the end, so memory use is one index entry per level plus
+// the ramps of garage levels
+class LevelPackWriter {
+public:
+    LevelPackWriter();
+
+    bool open(const std::string& path);
+    bool add(const LevelSetup& level);
+    // Writes the index and header; the pack is only valid after this succeeds
+    bool finish();
+
+    int size() const { return (int)index.size(); }
+
+private:
+    std::ofstream out;
+    std::string path;
+    std::vector<LevelPackEntry> index;
+    std::vector<PackedRamp> ramps;
+    uint64_t carCount;
+};
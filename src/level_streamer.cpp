@@ -0,0 +1,106 @@
+#include "level_streamer.h"
+
+#include <fstream>
+
+void prepareLevel(int number, PreparedLevel& level) {
+    level.number = number;
+    level.distances.reset();
+    groupCarsByFloor(level.setup, level.floorStart);
+    level.collision.build(level.setup.cars, level.setup.lot, level.setup.ramps);
+    // Boards past BOARD_KEY_BITS have no packed key; play without hints
+    level.boardValid = buildBoard(level.setup, level.board) && level.board.keyBits <= BOARD_KEY_BITS;
+    if (!level.boardValid) return;
+
+    buildZobristTable(level.board, level.zobrist);
+    level.startSlots = boardStartState(level.board);
+    level.startHash = zobristHash(level.zobrist, level.startSlots);
+    level.startKey = packBoardState(level.board, level.startSlots);
+
+    std::string databasePath = distanceDatabasePath(DISTANCE_DB_DIR, number);
+    if (std::ifstream(databasePath).good()) {
+        level.distances.reset(new DistanceDatabase());
+        if (!level.distances->open(databasePath, level.board)) level.distances.reset();
+    }
+}
+
+LevelStreamer::LevelStreamer(const LevelSource& levelSource)
+    : source(levelSource), stopping(false), requested(0), generation(0), ready(false), failed(false) {
+    worker = std::thread(&LevelStreamer::run, this);
+}
+
+LevelStreamer::~LevelStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void LevelStreamer::prefetch(int number) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requested == number) return;
+        // A level already being prepared finishes first and is then dropped
+        requested = number;
+        generation++;
+        ready = false;
+        failed = false;
+    }
+    wake.notify_one();
+}
+
+void LevelStreamer::invalidate(int number) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requested != number) return;
+        generation++;
+        ready = false;
+        failed = false;
+    }
+    wake.notify_one();
+}
+
+bool LevelStreamer::take(int number, PreparedLevel& level) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (requested != number) return false;
+    done.wait(lock, [this] { return ready || failed; });
+
+    bool ok = ready;
+    if (ok) level = std::move(prepared);
+    requested = 0;
+    ready = false;
+    failed = false;
+    return ok;
+}
+
+size_t LevelStreamer::readyCarCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ready ? prepared.setup.cars.size() : 0;
+}
+
+void LevelStreamer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || (requested != 0 && !ready && !failed); });
+        if (stopping) return;
+
+        int number = requested;
+        uint64_t startedGeneration = generation;
+        lock.unlock();
+
+        PreparedLevel level;
+        bool ok = source(number, level.setup);
+        if (ok) prepareLevel(number, level);
+
+        lock.lock();
+        if (generation != startedGeneration) continue;  // superseded or invalidated while we worked
+        if (ok) {
+            prepared = std::move(level);
+            ready = true;
+        } else {
+            failed = true;
+        }
+        done.notify_all();
+    }
+}
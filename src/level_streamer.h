@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "board.h"
+#include "collision_grid.h"
+#include "distance_db.h"
+#include "levels.h"
+
+// A level with everything the game derives from it already built, so that
+// starting it is a handful of moves
+struct PreparedLevel {
+    int number = 0;
+    LevelSetup setup;
+    bool boardValid = false;
+    Board board;
+    ZobristTable zobrist;
+    BoardState startSlots;
+    uint64_t startHash = 0;
+    BoardKey startKey = {0, 0};
+    std::unique_ptr<DistanceDatabase> distances;   // NULL unless DISTANCE_DB_DIR has this level
+    GarageCollision collision;
+    std::vector<int> floorStart;    // setup.cars grouped by floor, see groupCarsByFloor
+};
+
+// Fills level.setup for level `number`; must be safe to call off the main thread
+typedef std::function<bool(int number, LevelSetup& setup)> LevelSource;
+
+// Groups the cars by floor and builds the collision grids, board, Zobrist
+// table, start keys and distance database for level.setup (already filled in)
+void prepareLevel(int number, PreparedLevel& level);
+
+// Prepares the next level on a worker thread while the current one is played.
+// prefetch() queues a level, replacing any queued one; take() hands it over,
+// waiting if the worker is still on it, or returns false if a different level
+// was prefetched (the caller then prepares it itself).
+class LevelStreamer {
+public:
+    explicit LevelStreamer(const LevelSource& source);
+    ~LevelStreamer();
+
+    void prefetch(int number);
+    bool take(int number, PreparedLevel& level);
+
+    // The source of level `number` changed: if it is the prefetched level,
+    // throw the prepared copy away and prepare it again
+    void invalidate(int number);
+
+    // Cars in the prepared level, 0 while none is ready; lets the renderer
+    // size its buffers ahead of the switch
+    size_t readyCarCount();
+
+private:
+    void run();
+
+    LevelSource source;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping;
+
+    int requested;          // level queued or being prepared, 0 = none
+    uint64_t generation;    // bumped whenever work in progress goes stale
+    bool ready;
+    bool failed;            // the source could not provide `requested`
+    PreparedLevel prepared;
+};
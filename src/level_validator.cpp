@@ -0,0 +1,225 @@
+#include "level_validator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "board.h"
+#include "solver.h"
+
+static const float EDGE_TOLERANCE = 0.001f;
+
+static int toTicks(float value) {
+    return (int)std::lround(value * BOARD_TICKS_PER_UNIT);
+}
+
+static void addIssue(LevelValidation& result, const char* check, int car, const std::string& message) {
+    result.issues.push_back({check, car, message});
+}
+
+static std::string carName(int index) {
+    std::ostringstream out;
+    out << "car " << (index + 1);
+    return out.str();
+}
+
+// Extents of a car along / across its lane
+static float laneLength(const Car& car) { return car.isVertical ? car.size.z : car.size.x; }
+static float crossWidth(const Car& car) { return car.isVertical ? car.size.x : car.size.z; }
+static float lanePosition(const Car& car) { return car.isVertical ? car.position.z : car.position.x; }
+static float crossPosition(const Car& car) { return car.isVertical ? car.position.x : car.position.z; }
+
+static void checkLanes(const LevelSetup& level, LevelValidation& result) {
+    int slotTicks = toTicks(level.slotSize);
+    if (slotTicks <= 0) {
+        addIssue(result, CHECK_LANE, 0, "slot size must be positive");
+        return;
+    }
+    for (size_t i = 0; i < level.cars.size(); i++) {
+        const Car& car = level.cars[i];
+        int car1 = (int)i + 1;
+        int minTicks = toTicks(car.minPos);
+        int maxTicks = toTicks(car.maxPos);
+        int startTicks = toTicks(lanePosition(car));
+        if (maxTicks < minTicks) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " has maxPos < minPos");
+            continue;
+        }
+        if (startTicks < minTicks || startTicks > maxTicks) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " starts outside its minPos..maxPos");
+        } else if ((startTicks - minTicks) % slotTicks != 0) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " starts between slots");
+        }
+        if ((maxTicks - minTicks) % slotTicks != 0) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " has a lane that is not a whole number of slots");
+        } else if ((maxTicks - minTicks) / slotTicks + 1 > BOARD_MAX_SLOTS) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " has too many slots");
+        }
+        if (laneLength(car) < crossWidth(car)) {
+            addIssue(result, CHECK_LANE, car1, carName(i) + " lies across its lane");
+        }
+    }
+}
+
+// Every position a car can reach keeps it on the slab; only the target may
+// leave, through the exit on the right edge
+static void checkBounds(const LevelSetup& level, LevelValidation& result) {
+    float limitX = 0.5f * level.lot.width + EDGE_TOLERANCE;
+    float limitZ = 0.5f * level.lot.depth + EDGE_TOLERANCE;
+    for (size_t i = 0; i < level.cars.size(); i++) {
+        const Car& car = level.cars[i];
+        int car1 = (int)i + 1;
+        float halfLength = laneLength(car) / 2;
+        float halfWidth = crossWidth(car) / 2;
+        float laneLimit = car.isVertical ? limitZ : limitX;
+        float crossLimit = car.isVertical ? limitX : limitZ;
+        if (std::fabs(crossPosition(car)) + halfWidth > crossLimit) {
+            addIssue(result, CHECK_BOUNDS, car1, carName(i) + " runs in a lane outside the lot");
+        }
+        if (car.minPos - halfLength < -laneLimit) {
+            addIssue(result, CHECK_BOUNDS, car1, carName(i) + " can leave the lot at minPos");
+        }
+        bool exits = car.isTarget && !car.isVertical;
+        if (!exits && car.maxPos + halfLength > laneLimit) {
+            addIssue(result, CHECK_BOUNDS, car1, carName(i) + " can leave the lot at maxPos");
+        }
+    }
+}
+
+// Cars stand exactly on a floor; ramps lie inside the lot and lead to a floor
+static void checkFloors(const LevelSetup& level, LevelValidation& result) {
+    for (size_t i = 0; i < level.cars.size(); i++) {
+        const Car& car = level.cars[i];
+        int floor = carFloor(car);
+        if (floor < 0 || std::fabs(car.position.y - (CAR_GROUND_Y + floor * FLOOR_HEIGHT)) > EDGE_TOLERANCE) {
+            addIssue(result, CHECK_FLOOR, (int)i + 1, carName(i) + " is not standing on a floor");
+        }
+    }
+    float limitX = 0.5f * level.lot.width + EDGE_TOLERANCE;
+    float limitZ = 0.5f * level.lot.depth + EDGE_TOLERANCE;
+    for (size_t r = 0; r < level.ramps.size(); r++) {
+        const Ramp& ramp = level.ramps[r];
+        std::string name = "ramp " + std::to_string(r + 1);
+        if (ramp.floor < 0 || !(ramp.x0 < ramp.x1 && ramp.z0 < ramp.z1)) {
+            addIssue(result, CHECK_FLOOR, 0, name + " is empty or below the ground floor");
+        } else if (ramp.x0 < -limitX || ramp.x1 > limitX || ramp.z0 < -limitZ || ramp.z1 > limitZ) {
+            addIssue(result, CHECK_FLOOR, 0, name + " reaches outside the lot");
+        }
+    }
+}
+
+static void checkTarget(const LevelSetup& level, LevelValidation& result) {
+    int targets = 0;
+    for (size_t i = 0; i < level.cars.size(); i++) {
+        const Car& car = level.cars[i];
+        if (!car.isTarget) continue;
+        int car1 = (int)i + 1;
+        if (++targets > 1) {
+            addIssue(result, CHECK_TARGET, car1, carName(i) + " is a second target car");
+            continue;
+        }
+        if (car.isVertical) {
+            addIssue(result, CHECK_TARGET, car1, "the target car must be horizontal");
+            continue;
+        }
+        if (carFloor(car) != 0) {
+            addIssue(result, CHECK_TARGET, car1, "the target car must be on the ground floor");
+        }
+        const LotLayout& lot = level.lot;
+        if (car.maxPos < lot.exitX) {
+            addIssue(result, CHECK_TARGET, car1, "the target car can never reach the exit");
+        }
+        if (car.position.x >= lot.exitX) {
+            addIssue(result, CHECK_TARGET, car1, "the target car starts at the exit");
+        }
+        if (std::fabs(car.position.z - lot.exitZ) > 0.5f * lot.exitWidth + EDGE_TOLERANCE) {
+            addIssue(result, CHECK_TARGET, car1, "the target car is not in the exit's row");
+        }
+    }
+    if (targets == 0) addIssue(result, CHECK_TARGET, 0, "no target car");
+}
+
+// Same test as checkCollision (carsOverlap), swept along x so large lots stay
+// near-linear
+static void checkOverlaps(const LevelSetup& level, LevelValidation& result) {
+    const std::vector<Car>& cars = level.cars;
+    std::vector<int> order(cars.size());
+    for (size_t i = 0; i < cars.size(); i++) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&cars](int a, int b) {
+        return cars[a].position.x - cars[a].size.x / 2 < cars[b].position.x - cars[b].size.x / 2;
+    });
+
+    for (size_t n = 0; n < order.size(); n++) {
+        const Car& car = cars[order[n]];
+        float right = car.position.x + car.size.x / 2;
+        for (size_t m = n + 1; m < order.size(); m++) {
+            const Car& other = cars[order[m]];
+            if (other.position.x - other.size.x / 2 >= right) break;
+            if (carsOverlap(car, other, level.ramps)) {
+                int first = std::min(order[n], order[m]);
+                int second = std::max(order[n], order[m]);
+                addIssue(result, CHECK_OVERLAP, first + 1, carName(first) + " overlaps " + carName(second));
+            }
+        }
+    }
+}
+
+static void checkSolvable(const LevelSetup& level, const ValidatorOptions& options, LevelValidation& result) {
+    if (level.cars.size() > 255) {
+        // Past what the solvers can index; nothing is known about solvability
+        result.aborted = true;
+        return;
+    }
+    Board board;
+    if (!buildBoard(level, board)) {
+        addIssue(result, CHECK_SOLVABLE, 0, "the solver cannot represent this level");
+        return;
+    }
+    if (board.keyBits > BOARD_KEY_BITS) {
+        // Too many states to pack into a search key; solvability unknown
+        result.aborted = true;
+        return;
+    }
+
+    result.searched = true;
+    BoardState start = boardStartState(board);
+    if (boardHeuristic(board, start) >= BOARD_DEAD_END) {
+        addIssue(result, CHECK_SOLVABLE, 0, "a car blocks the exit row for good");
+        return;
+    }
+    SolveOptions solveOptions;
+    solveOptions.maxStates = options.maxStates;
+    SolveResult solved;
+    if (!solveBfs(board, start, solveOptions, solved)) {
+        result.aborted = true;
+        return;
+    }
+    result.states = solved.stats.stored;
+    if (solved.solved) {
+        result.solved = true;
+        result.moves = (int)solved.moves.size();
+    } else if (solved.aborted) {
+        result.aborted = true;
+    } else {
+        addIssue(result, CHECK_SOLVABLE, 0, "no sequence of moves frees the target car");
+    }
+}
+
+const char* LevelValidation::status() const {
+    for (const LevelIssue& issue : issues) {
+        if (std::strcmp(issue.check, CHECK_SOLVABLE) != 0) return "invalid";
+    }
+    if (!issues.empty()) return "unsolvable";
+    return aborted ? "unknown" : "ok";
+}
+
+void validateLevel(const LevelSetup& level, const ValidatorOptions& options, LevelValidation& result) {
+    result = LevelValidation();
+    checkLanes(level, result);
+    checkBounds(level, result);
+    checkFloors(level, result);
+    checkTarget(level, result);
+    checkOverlaps(level, result);
+    if (options.solve && result.issues.empty()) checkSolvable(level, options, result);
+}
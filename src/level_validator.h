@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "levels.h"
+
+// Sanity checks for authored or generated levels, without the game.
+//
+// Structural checks first: cars overlapping at the start, cars that can leave
+// the level's lot, cars off their own lane or between floors, ramps, and
+// target placement. Only a level that passes them is searched for a solution.
+
+// Names of the checks, as they appear in reports
+const char* const CHECK_OVERLAP = "overlap";
+const char* const CHECK_BOUNDS = "bounds";
+const char* const CHECK_LANE = "lane";
+const char* const CHECK_TARGET = "target";
+const char* const CHECK_FLOOR = "floor";
+const char* const CHECK_SOLVABLE = "solvable";
+
+struct ValidatorOptions {
+    bool solve = true;
+    uint64_t maxStates = 500000;     // BFS cap per level; bigger levels report "unknown"
+};
+
+struct LevelIssue {
+    const char* check;
+    int car;                // 1-based like the selection keys, 0 = the level as a whole
+    std::string message;
+};
+
+struct LevelValidation {
+    std::vector<LevelIssue> issues;
+    bool searched = false;  // structure was fine and the solver ran
+    bool solved = false;
+    bool aborted = false;   // hit maxStates or too big to search: solvability unknown
+    int moves = 0;          // optimal length in slides when solved
+    uint64_t states = 0;    // states the search stored
+
+    // "ok", "invalid", "unsolvable" or "unknown"
+    const char* status() const;
+};
+
+void validateLevel(const LevelSetup& level, const ValidatorOptions& options, LevelValidation& result);
@@ -0,0 +1,123 @@
+#include "level_watcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "levels.h"
+#include "process_stats.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+int levelNumberFromFileName(const std::string& name) {
+    const std::string prefix = "level";
+    const std::string suffix = ".lvl";
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return 0;
+    }
+    std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (digits.find_first_not_of("0123456789") != std::string::npos) return 0;
+    return std::atoi(digits.c_str());
+}
+
+#ifdef __linux__
+
+LevelWatcher::LevelWatcher() : watching(false), inotifyFd(-1) {}
+
+bool LevelWatcher::start(const std::string& watchDirectory, int) {
+    stop();
+    directory = watchDirectory;
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        std::cerr << "Level watcher: inotify is unavailable" << std::endl;
+        return false;
+    }
+    uint32_t events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM;
+    if (inotify_add_watch(inotifyFd, directory.c_str(), events) < 0) {
+        stop();
+        return false;
+    }
+    watching = true;
+    return true;
+}
+
+void LevelWatcher::stop() {
+    if (inotifyFd >= 0) ::close(inotifyFd);
+    inotifyFd = -1;
+    watching = false;
+}
+
+void LevelWatcher::poll(std::vector<int>& changed) {
+    changed.clear();
+    if (!watching) return;
+
+    alignas(struct inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;     // EAGAIN: nothing more queued
+        for (char* at = buffer; at < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)at;
+            int level = event->len > 0 ? levelNumberFromFileName(event->name) : 0;
+            if (level > 0 && std::find(changed.begin(), changed.end(), level) == changed.end()) {
+                changed.push_back(level);
+            }
+            at += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+#else
+
+static const double SCAN_INTERVAL = 0.5;   // seconds between stat sweeps
+
+static std::time_t modificationTime(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+LevelWatcher::LevelWatcher() : watching(false), lastScan(0.0) {}
+
+bool LevelWatcher::start(const std::string& watchDirectory, int levelCount) {
+    stop();
+    struct stat info;
+    if (stat(watchDirectory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)) return false;
+
+    directory = watchDirectory;
+    stamps.assign(levelCount + 1, 0);
+    for (int level = 1; level <= levelCount; level++) {
+        stamps[level] = modificationTime(levelFilePath(directory, level));
+    }
+    lastScan = monotonicSeconds();
+    watching = true;
+    return true;
+}
+
+void LevelWatcher::stop() {
+    stamps.clear();
+    watching = false;
+}
+
+void LevelWatcher::poll(std::vector<int>& changed) {
+    changed.clear();
+    if (!watching || monotonicSeconds() - lastScan < SCAN_INTERVAL) return;
+    lastScan = monotonicSeconds();
+
+    for (int level = 1; level < (int)stamps.size(); level++) {
+        std::time_t stamp = modificationTime(levelFilePath(directory, level));
+        if (stamp != stamps[level]) {
+            stamps[level] = stamp;
+            changed.push_back(level);
+        }
+    }
+}
+
+#endif
+
+LevelWatcher::~LevelWatcher() {
+    stop();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Watches a directory of level<N>.lvl files for edits and deletions. On Linux
+// this is an inotify watch (a file is reported once it is closed after
+// writing or renamed into place, which covers editors that save through a
+// temp file); elsewhere the files of levels 1..levelCount are re-stat'ed
+// twice a second.
+class LevelWatcher {
+public:
+    LevelWatcher();
+    ~LevelWatcher();
+
+    LevelWatcher(const LevelWatcher&) = delete;
+    LevelWatcher& operator=(const LevelWatcher&) = delete;
+
+    // False if the directory cannot be watched (it may simply not exist)
+    bool start(const std::string& directory, int levelCount);
+    void stop();
+
+    bool isWatching() const { return watching; }
+
+    // Level numbers whose file changed since the last call, each once; never blocks
+    void poll(std::vector<int>& changed);
+
+private:
+    std::string directory;
+    bool watching;
+#ifdef __linux__
+    int inotifyFd;
+#else
+    std::vector<std::time_t> stamps;    // modification time per level, 0 = no file
+    double lastScan;
+#endif
+};
+
+// Level number of a "level<N>.lvl" file name, 0 if it is not one
+int levelNumberFromFileName(const std::string& name);
@@ -0,0 +1,485 @@
+#include "levels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "level_pack.h"
+
+namespace {
+
+// The built-in levels are read-only PackedCar records, the exact in-memory
+// layout of Car (see level_pack.h): the compiler checks them below and
+// setupBuiltinLevel copies a level's cars with one memcpy.
+struct BuiltinLevel {
+    float gameTime;
+    int score;
+    float slotSize;
+    const PackedCar* cars;
+    size_t carCount;
+};
+
+// position, size, color, isVertical, isTarget, padding, id, minPos, maxPos
+constexpr PackedCar LEVEL1_CARS[] = {
+    {{-3.0f, 0.4f, 0.0f}, {2.5f, 0.8f, 1.2f}, {1.0f, 0.0f, 0.0f}, 0, 1, {}, 0, -5.0f, 6.5f},
+    {{1.0f, 0.4f, 2.5f}, {1.2f, 0.8f, 2.5f}, {0.2f, 0.5f, 1.0f}, 1, 0, {}, 1, -4.0f, 4.0f},
+    {{3.0f, 0.4f, -1.0f}, {1.2f, 0.8f, 3.0f}, {0.2f, 1.0f, 0.5f}, 1, 0, {}, 2, -4.0f, 4.0f},
+    {{-1.5f, 0.4f, -3.0f}, {2.0f, 0.8f, 1.2f}, {1.0f, 1.0f, 0.2f}, 0, 0, {}, 3, -5.0f, 5.0f},
+};
+
+constexpr PackedCar LEVEL2_CARS[] = {
+    {{-4.0f, 0.4f, 0.0f}, {2.5f, 0.8f, 1.2f}, {1.0f, 0.0f, 0.0f}, 0, 1, {}, 0, -5.0f, 6.5f},
+    {{0.0f, 0.4f, 2.0f}, {1.2f, 0.8f, 2.5f}, {0.2f, 0.5f, 1.0f}, 1, 0, {}, 1, -4.0f, 4.0f},
+    {{2.5f, 0.4f, 0.0f}, {1.2f, 0.8f, 3.0f}, {0.2f, 1.0f, 0.5f}, 1, 0, {}, 2, -4.0f, 4.0f},
+    {{-2.0f, 0.4f, -2.5f}, {2.0f, 0.8f, 1.2f}, {1.0f, 1.0f, 0.2f}, 0, 0, {}, 3, -5.0f, 5.0f},
+    {{-3.5f, 0.4f, 3.0f}, {1.2f, 0.8f, 2.0f}, {1.0f, 0.5f, 0.0f}, 1, 0, {}, 4, -4.0f, 4.0f},
+    {{4.0f, 0.4f, -3.0f}, {1.2f, 0.8f, 2.0f}, {0.5f, 0.0f, 1.0f}, 1, 0, {}, 5, -4.0f, 4.0f},
+};
+
+constexpr PackedCar LEVEL3_CARS[] = {
+    {{-4.5f, 0.4f, 0.0f}, {2.5f, 0.8f, 1.2f}, {1.0f, 0.0f, 0.0f}, 0, 1, {}, 0, -5.0f, 6.5f},
+    {{-1.0f, 0.4f, 2.0f}, {1.2f, 0.8f, 2.5f}, {0.2f, 0.5f, 1.0f}, 1, 0, {}, 1, -4.0f, 4.0f},
+    {{1.5f, 0.4f, 0.5f}, {1.2f, 0.8f, 3.0f}, {0.2f, 1.0f, 0.5f}, 1, 0, {}, 2, -4.0f, 4.0f},
+    {{-2.5f, 0.4f, -2.5f}, {2.0f, 0.8f, 1.2f}, {1.0f, 1.0f, 0.2f}, 0, 0, {}, 3, -5.0f, 5.0f},
+    {{-3.5f, 0.4f, 3.5f}, {1.2f, 0.8f, 2.0f}, {1.0f, 0.5f, 0.0f}, 1, 0, {}, 4, -4.0f, 4.0f},
+    {{4.0f, 0.4f, -2.0f}, {1.2f, 0.8f, 2.5f}, {0.5f, 0.0f, 1.0f}, 1, 0, {}, 5, -4.0f, 4.0f},
+    {{1.0f, 0.4f, -4.0f}, {2.5f, 0.8f, 1.2f}, {0.0f, 0.8f, 0.8f}, 0, 0, {}, 6, -5.0f, 5.0f},
+};
+
+constexpr BuiltinLevel BUILTIN_LEVELS[] = {
+    {120.0f, 1000, 0.5f, LEVEL1_CARS, sizeof(LEVEL1_CARS) / sizeof(PackedCar)},
+    {150.0f, 1500, 0.5f, LEVEL2_CARS, sizeof(LEVEL2_CARS) / sizeof(PackedCar)},
+    {180.0f, 2000, 0.5f, LEVEL3_CARS, sizeof(LEVEL3_CARS) / sizeof(PackedCar)},
+};
+
+// Compile-time versions of the validator's structural checks. The built-in
+// levels are single-floor, so the overlap test is checkCollision's box test.
+constexpr bool packedCarsOverlap(const PackedCar& a, const PackedCar& b) {
+    return a.position[0] - a.size[0] / 2 < b.position[0] + b.size[0] / 2 &&
+           a.position[0] + a.size[0] / 2 > b.position[0] - b.size[0] / 2 &&
+           a.position[2] - a.size[2] / 2 < b.position[2] + b.size[2] / 2 &&
+           a.position[2] + a.size[2] / 2 > b.position[2] - b.size[2] / 2;
+}
+
+template <size_t N>
+constexpr bool noCarsOverlap(const PackedCar (&cars)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (packedCarsOverlap(cars[i], cars[j])) return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool carsInsideLanes(const PackedCar (&cars)[N]) {
+    for (const PackedCar& car : cars) {
+        float lane = car.isVertical ? car.position[2] : car.position[0];
+        if (car.minPos > car.maxPos || lane < car.minPos || lane > car.maxPos) return false;
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr int targetCount(const PackedCar (&cars)[N]) {
+    int targets = 0;
+    for (const PackedCar& car : cars) targets += car.isTarget;
+    return targets;
+}
+
+// The bool bytes must hold 0 or 1 to be copied into Car; ids are the car's index
+template <size_t N>
+constexpr bool carsWellFormed(const PackedCar (&cars)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (cars[i].isVertical > 1 || cars[i].isTarget > 1 || cars[i].id != (int32_t)i) return false;
+        if (cars[i].position[1] != CAR_GROUND_Y) return false;
+    }
+    return true;
+}
+
+static_assert(sizeof(BUILTIN_LEVELS) / sizeof(BuiltinLevel) == BUILTIN_LEVEL_COUNT, "BUILTIN_LEVEL_COUNT is stale");
+static_assert(noCarsOverlap(LEVEL1_CARS), "level 1: two cars overlap");
+static_assert(noCarsOverlap(LEVEL2_CARS), "level 2: two cars overlap");
+static_assert(noCarsOverlap(LEVEL3_CARS), "level 3: two cars overlap");
+static_assert(carsInsideLanes(LEVEL1_CARS), "level 1: a car starts outside minPos..maxPos");
+static_assert(carsInsideLanes(LEVEL2_CARS), "level 2: a car starts outside minPos..maxPos");
+static_assert(carsInsideLanes(LEVEL3_CARS), "level 3: a car starts outside minPos..maxPos");
+static_assert(targetCount(LEVEL1_CARS) == 1, "level 1 needs exactly one target car");
+static_assert(targetCount(LEVEL2_CARS) == 1, "level 2 needs exactly one target car");
+static_assert(targetCount(LEVEL3_CARS) == 1, "level 3 needs exactly one target car");
+static_assert(carsWellFormed(LEVEL1_CARS), "level 1: bad flag, id or height");
+static_assert(carsWellFormed(LEVEL2_CARS), "level 2: bad flag, id or height");
+static_assert(carsWellFormed(LEVEL3_CARS), "level 3: bad flag, id or height");
+
+} // namespace
+
+bool setupBuiltinLevel(int levelNumber, LevelSetup& level) {
+    if (levelNumber < 1 || levelNumber > BUILTIN_LEVEL_COUNT) return false;
+    const BuiltinLevel& builtin = BUILTIN_LEVELS[levelNumber - 1];
+    level.gameTime = builtin.gameTime;
+    level.score = builtin.score;
+    level.slotSize = builtin.slotSize;
+    level.lot = LotLayout();
+    level.ramps.clear();
+    level.cars.resize(builtin.carCount);
+    std::memcpy(static_cast<void*>(level.cars.data()), builtin.cars, builtin.carCount * sizeof(PackedCar));
+    return true;
+}
+
+namespace {
+
+const glm::vec3 GRID_TARGET_COLOR(1.0f, 0.0f, 0.0f);
+const glm::vec3 GRID_WALL_COLOR(0.4f, 0.4f, 0.4f);
+const glm::vec3 GRID_CAR_COLORS[] = {
+    glm::vec3(0.2f, 0.5f, 1.0f), glm::vec3(0.2f, 1.0f, 0.5f), glm::vec3(1.0f, 1.0f, 0.2f),
+    glm::vec3(1.0f, 0.5f, 0.0f), glm::vec3(0.5f, 0.0f, 1.0f), glm::vec3(0.0f, 0.8f, 0.8f),
+};
+const int GRID_CAR_COLOR_COUNT = sizeof(GRID_CAR_COLORS) / sizeof(GRID_CAR_COLORS[0]);
+
+// Next line with its comment stripped; false at end of file
+bool readDirective(std::istream& in, std::string& line, int& lineNumber) {
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        if (line.find_first_not_of(" \t\r") != std::string::npos) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+LotLayout gridLot(int columns, int rows, float cell) {
+    LotLayout lot;
+    lot.width = columns * cell;
+    lot.depth = rows * cell;
+    lot.cell = cell;
+    lot.exitX = 0.5f * lot.width;
+    lot.exitZ = 0.0f;
+    lot.exitWidth = cell;
+    return lot;
+}
+
+Car gridCar(const LotLayout& lot, int row, int column, int length, bool vertical, bool target, int colorIndex) {
+    float cell = lot.cell;
+    float left = -0.5f * lot.width;
+    float top = -0.5f * lot.depth;
+    float gap = 0.2f * cell;
+    float half = 0.5f * length * cell;
+
+    Car car;
+    car.isVertical = vertical;
+    car.isTarget = target;
+    car.id = 0;
+    car.baseColor = target ? GRID_TARGET_COLOR : GRID_CAR_COLORS[colorIndex % GRID_CAR_COLOR_COUNT];
+    if (vertical) {
+        car.position = glm::vec3(left + (column + 0.5f) * cell, 0.4f, top + row * cell + half);
+        car.size = glm::vec3(cell - 2.0f * gap, 0.8f, length * cell - gap);
+        car.minPos = top + half;
+        car.maxPos = top + lot.depth - half;
+    } else {
+        car.position = glm::vec3(left + column * cell + half, 0.4f, top + (row + 0.5f) * cell);
+        car.size = glm::vec3(length * cell - gap, 0.8f, cell - 2.0f * gap);
+        car.minPos = left + half;
+        car.maxPos = 0.5f * lot.width - half;
+    }
+    // The target may drive one cell past the edge, which is where it crosses the exit line
+    if (target) car.maxPos += cell;
+    return car;
+}
+
+Car gridWall(const LotLayout& lot, int row, int column) {
+    float cell = lot.cell;
+    float gap = 0.2f * cell;
+    glm::vec3 position(-0.5f * lot.width + (column + 0.5f) * cell, 0.4f, -0.5f * lot.depth + (row + 0.5f) * cell);
+    return {position, glm::vec3(cell - gap, 0.8f, cell - gap), GRID_WALL_COLOR, false, false, 0,
+            position.x, position.x};
+}
+
+void placeGridExit(LotLayout& lot, const Car& target) {
+    lot.exitX = target.maxPos - 0.5f * lot.cell;
+    lot.exitZ = target.position.z;
+}
+
+// Each letter must form one straight run of at least two cells; walls are
+// single cells that cannot move
+bool gridLevelCars(const std::vector<std::string>& rows, float cell, int floor, LevelSetup& level,
+                   std::string& error) {
+    int columns = rows.empty() ? 0 : (int)rows[0].size();
+    for (const std::string& row : rows) {
+        if ((int)row.size() != columns) {
+            error = "grid rows differ in length";
+            return false;
+        }
+    }
+    LotLayout& lot = level.lot;
+    LotLayout fitted = gridLot(columns, (int)rows.size(), cell);
+    if (floor == 0) {
+        lot = fitted;
+    } else {
+        // Upper floors share the footprint and leave the ground floor's exit alone
+        lot.width = fitted.width;
+        lot.depth = fitted.depth;
+        lot.cell = fitted.cell;
+    }
+    float lift = floor * FLOOR_HEIGHT;
+
+    std::map<char, std::vector<int> > cells;    // letter -> row * columns + column, in reading order
+    std::vector<Car> walls;
+    for (size_t r = 0; r < rows.size(); r++) {
+        for (int c = 0; c < columns; c++) {
+            char ch = rows[r][c];
+            if (ch == '.' || ch == 'o') continue;
+            if (ch == 'x') {
+                walls.push_back(gridWall(lot, (int)r, c));
+                walls.back().position.y += lift;
+                continue;
+            }
+            if (ch == '^') {
+                float x0 = -0.5f * lot.width + c * cell;
+                float z0 = -0.5f * lot.depth + r * cell;
+                level.ramps.push_back({floor, x0, z0, x0 + cell, z0 + cell});
+                continue;
+            }
+            if (!std::isalpha((unsigned char)ch)) {
+                error = std::string("unknown grid character '") + ch + "'";
+                return false;
+            }
+            cells[ch].push_back((int)r * columns + c);
+        }
+    }
+    if (floor == 0 && !cells.count('A')) {
+        error = "grid has no target car 'A'";
+        return false;
+    }
+    if (floor != 0 && cells.count('A')) {
+        error = "the target car 'A' must be on the ground floor";
+        return false;
+    }
+
+    // The target goes first, like in the built-in levels
+    std::vector<char> order;
+    if (floor == 0) order.push_back('A');
+    for (const auto& entry : cells) {
+        if (entry.first != 'A') order.push_back(entry.first);
+    }
+
+    int colorIndex = 0;
+    for (char letter : order) {
+        const std::vector<int>& run = cells[letter];
+        int length = (int)run.size();
+        int row = run[0] / columns;
+        int column = run[0] % columns;
+        bool vertical = length > 1 && run[1] - run[0] == columns;
+        int step = vertical ? columns : 1;
+        bool straight = length > 1;
+        for (int i = 1; i < length && straight; i++) {
+            straight = run[i] - run[i - 1] == step && (vertical || run[i] / columns == row);
+        }
+        if (!straight) {
+            error = std::string("car '") + letter + "' is not a straight run of two or more cells";
+            return false;
+        }
+        bool target = letter == 'A';
+        if (target && vertical) {
+            error = "the target car 'A' must be horizontal";
+            return false;
+        }
+
+        level.cars.push_back(gridCar(lot, row, column, length, vertical, target, target ? 0 : colorIndex++));
+        level.cars.back().position.y += lift;
+        if (target) placeGridExit(lot, level.cars.back());
+    }
+    level.cars.insert(level.cars.end(), walls.begin(), walls.end());
+    return true;
+}
+
+int levelFloorCount(const LevelSetup& level) {
+    int top = 0;
+    for (const Car& car : level.cars) top = std::max(top, carFloor(car));
+    for (const Ramp& ramp : level.ramps) top = std::max(top, ramp.floor + 1);
+    return top + 1;
+}
+
+bool carsOverlap(const Car& a, const Car& b, const std::vector<Ramp>& ramps) {
+    // The part of the lot both footprints cover, if any
+    float x0 = std::max(a.position.x - a.size.x / 2, b.position.x - b.size.x / 2);
+    float x1 = std::min(a.position.x + a.size.x / 2, b.position.x + b.size.x / 2);
+    float z0 = std::max(a.position.z - a.size.z / 2, b.position.z - b.size.z / 2);
+    float z1 = std::min(a.position.z + a.size.z / 2, b.position.z + b.size.z / 2);
+    if (!(x0 < x1 && z0 < z1)) return false;
+
+    int floorA = carFloor(a);
+    int floorB = carFloor(b);
+    if (floorA == floorB) return true;
+    if (std::abs(floorA - floorB) != 1) return false;
+    int lower = std::min(floorA, floorB);
+    for (const Ramp& ramp : ramps) {
+        if (ramp.floor == lower && std::max(x0, ramp.x0) < std::min(x1, ramp.x1) &&
+            std::max(z0, ramp.z0) < std::min(z1, ramp.z1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void groupCarsByFloor(LevelSetup& level, std::vector<int>& floorStart) {
+    std::vector<Car>& cars = level.cars;
+    auto byFloor = [](const Car& a, const Car& b) { return carFloor(a) < carFloor(b); };
+    if (!std::is_sorted(cars.begin(), cars.end(), byFloor)) std::stable_sort(cars.begin(), cars.end(), byFloor);
+
+    int floors = levelFloorCount(level);
+    floorStart.assign(floors + 1, (int)cars.size());
+    for (int i = (int)cars.size() - 1; i >= 0; i--) {
+        int floor = carFloor(cars[i]);
+        if (floor >= 0) floorStart[floor] = i;
+    }
+    // Floors without cars start where the next floor does; cars below ground count as floor 0
+    floorStart[0] = 0;
+    for (int f = floors - 1; f > 0; f--) floorStart[f] = std::min(floorStart[f], floorStart[f + 1]);
+}
+
+std::string levelFilePath(const std::string& directory, int levelNumber) {
+    std::stringstream ss;
+    ss << directory << "/level" << levelNumber << ".lvl";
+    return ss.str();
+}
+
+bool loadLevelFile(const std::string& path, LevelSetup& level) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Level: cannot open " << path << std::endl;
+        return false;
+    }
+
+    level.gameTime = 120.0f;
+    level.score = 1000;
+    level.slotSize = 0.5f;
+    level.lot = LotLayout();
+    level.cars.clear();
+    level.ramps.clear();
+
+    std::string line;
+    int lineNumber = 0;
+    int gridFloor = 0;
+    while (readDirective(in, line, lineNumber)) {
+        std::istringstream fields(line);
+        std::string directive;
+        fields >> directive;
+        std::string error;
+
+        if (directive == "time") {
+            if (!(fields >> level.gameTime) || level.gameTime <= 0.0f) error = "bad time";
+        } else if (directive == "score") {
+            if (!(fields >> level.score)) error = "bad score";
+        } else if (directive == "slot") {
+            if (!(fields >> level.slotSize) || level.slotSize <= 0.0f) error = "bad slot size";
+        } else if (directive == "lot") {
+            LotLayout& lot = level.lot;
+            if (!(fields >> lot.width >> lot.depth >> lot.cell) || lot.width <= 0.0f || lot.depth <= 0.0f ||
+                lot.cell <= 0.0f) {
+                error = "expected: lot width depth cell";
+            }
+        } else if (directive == "exit") {
+            LotLayout& lot = level.lot;
+            if (!(fields >> lot.exitX >> lot.exitZ >> lot.exitWidth) || lot.exitWidth <= 0.0f) {
+                error = "expected: exit x z width";
+            }
+        } else if (directive == "car") {
+            Car car;
+            std::string axis, role;
+            if (!(fields >> car.position.x >> car.position.y >> car.position.z >> car.size.x >> car.size.y >>
+                  car.size.z >> car.baseColor.r >> car.baseColor.g >> car.baseColor.b >> axis >> role >>
+                  car.minPos >> car.maxPos) ||
+                (axis != "h" && axis != "v") || (role != "target" && role != "-")) {
+                error = "expected: car x y z sx sy sz r g b h|v target|- minPos maxPos";
+            } else {
+                car.isVertical = axis == "v";
+                car.isTarget = role == "target";
+                car.id = 0;
+                level.cars.push_back(car);
+            }
+        } else if (directive == "ramp") {
+            Ramp ramp;
+            if (!(fields >> ramp.floor >> ramp.x0 >> ramp.z0 >> ramp.x1 >> ramp.z1) || ramp.floor < 0 ||
+                ramp.x1 <= ramp.x0 || ramp.z1 <= ramp.z0) {
+                error = "expected: ramp floor x0 z0 x1 z1";
+            } else {
+                level.ramps.push_back(ramp);
+            }
+        } else if (directive == "floor") {
+            if (!(fields >> gridFloor) || gridFloor < 0) error = "bad floor";
+        } else if (directive == "grid") {
+            int columns = 0, rows = 0;
+            float cell = 0.0f;
+            if (!(fields >> columns >> rows >> cell) || columns < 1 || rows < 1 || cell <= 0.0f) {
+                error = "expected: grid columns rows cell";
+            }
+            std::vector<std::string> grid;
+            while (error.empty() && (int)grid.size() < rows) {
+                std::string row;
+                if (!readDirective(in, line, lineNumber) || !(std::istringstream(line) >> row)) {
+                    error = "grid ends early";
+                } else if ((int)row.size() != columns) {
+                    error = "grid row is not " + std::to_string(columns) + " characters";
+                } else {
+                    grid.push_back(row);
+                }
+            }
+            if (error.empty()) gridLevelCars(grid, cell, gridFloor, level, error);
+        } else {
+            error = "unknown directive '" + directive + "'";
+        }
+
+        if (!error.empty()) {
+            std::cerr << path << ":" << lineNumber << ": " << error << std::endl;
+            return false;
+        }
+    }
+
+    if (level.cars.empty()) {
+        std::cerr << path << ": level has no cars" << std::endl;
+        return false;
+    }
+    std::vector<int> floorStart;
+    groupCarsByFloor(level, floorStart);
+    for (size_t i = 0; i < level.cars.size(); i++) level.cars[i].id = (int)i;
+    return true;
+}
+
+bool saveLevelFile(const std::string& path, const LevelSetup& level) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Level: cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << "time " << level.gameTime << "\n";
+    out << "score " << level.score << "\n";
+    out << "slot " << level.slotSize << "\n";
+    const LotLayout& lot = level.lot;
+    out << "lot " << lot.width << " " << lot.depth << " " << lot.cell << "\n";
+    out << "exit " << lot.exitX << " " << lot.exitZ << " " << lot.exitWidth << "\n";
+    out << "# car x y z  size x y z  color r g b  axis  role  minPos maxPos\n";
+    for (const Car& car : level.cars) {
+        out << "car " << car.position.x << " " << car.position.y << " " << car.position.z << "  "
+            << car.size.x << " " << car.size.y << " " << car.size.z << "  "
+            << car.baseColor.r << " " << car.baseColor.g << " " << car.baseColor.b << "  "
+            << (car.isVertical ? "v" : "h") << " " << (car.isTarget ? "target" : "-") << "  "
+            << car.minPos << " " << car.maxPos << "\n";
+    }
+    for (const Ramp& ramp : level.ramps) {
+        out << "ramp " << ramp.floor << "  " << ramp.x0 << " " << ramp.z0 << " " << ramp.x1 << " " << ramp.z1 << "\n";
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Level: error writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "car.h"
+
+// The ground the cars stand on: a width x depth slab centered on the origin
+// with grid lines every `cell`, and the exit on its right edge. The defaults
+// are the original 12x12 lot.
+struct LotLayout {
+    float width = 12.0f;
+    float depth = 12.0f;
+    float cell = 1.2f;          // grid line spacing, from the slab edges
+    float exitX = 5.5f;         // the target car wins once position.x >= exitX
+    float exitZ = 0.0f;         // center of the exit marker along the right edge
+    float exitWidth = 2.0f;     // length of the exit marker along z
+};
+
+// A ramp joins `floor` and the floor above over an x/z rectangle of the lot.
+// Cars on different floors only meet inside a ramp: two cars on neighbouring
+// floors block each other where both reach into the same ramp.
+struct Ramp {
+    int floor;
+    float x0, z0, x1, z1;
+};
+
+// Everything loadLevel needs to start a level. Every floor of a garage level
+// shares the lot's footprint; the exit is on the ground floor.
+struct LevelSetup {
+    float gameTime;
+    int score;
+    float slotSize;         // lattice the solvers search on (see buildBoard)
+    LotLayout lot;
+    std::vector<Car> cars;
+    std::vector<Ramp> ramps;    // empty for single-floor levels
+};
+
+// Floors in use: 1 + the highest floor a car stands on or a ramp leads to
+int levelFloorCount(const LevelSetup& level);
+
+// The overlap test checkCollision makes, across floors: cars on one floor
+// overlap as boxes, cars on neighbouring floors only inside a ramp between them
+bool carsOverlap(const Car& a, const Car& b, const std::vector<Ramp>& ramps);
+
+// Stable-sorts the cars floor by floor; floor f's cars are then
+// [floorStart[f], floorStart[f + 1]). Single-floor levels keep their order.
+void groupCarsByFloor(LevelSetup& level, std::vector<int>& floorStart);
+
+const int BUILTIN_LEVEL_COUNT = 3;
+
+// Fills `level` with built-in level 1..BUILTIN_LEVEL_COUNT; false if out of range.
+// The levels are compiled in and checked at compile time (overlaps, lanes,
+// one target), so this is a copy of read-only data.
+bool setupBuiltinLevel(int levelNumber, LevelSetup& level);
+
+// Text level files (.lvl), one directive per line, '#' starts a comment:
+//   time <seconds>
+//   score <points>
+//   slot <world units>            solver lattice, default 0.5
+//   lot <width> <depth> <cell>    slab size and grid line spacing, default 12 12 1.2
+//   exit <x> <z> <width>          win line, exit marker center and length, default 5.5 0 2
+//   car <x> <y> <z> <size x> <size y> <size z> <r> <g> <b> <h|v> <target|-> <minPos> <maxPos>
+//                                 y is CAR_GROUND_Y + floor * FLOOR_HEIGHT
+//   ramp <floor> <x0> <z0> <x1> <z1>  ramp from <floor> to the floor above
+//   floor <n>                     the grids that follow describe floor n, default 0
+//   grid <columns> <rows> <cell>  followed by <rows> lines of <columns> characters:
+//                                 'A' the target car, other letters one car each,
+//                                 'x' a wall, '^' a ramp up to the next floor,
+//                                 '.' or 'o' empty. Sets the lot to the grid (see
+//                                 gridLot) and the exit to the target's row; later
+//                                 lot/exit lines override. Only the ground floor's
+//                                 grid has (and needs) the target.
+// Cars are grouped floor by floor (groupCarsByFloor), then ids are assigned in
+// that order; a single-floor file keeps its order.
+
+// The game plays LEVEL_FILE_DIR/level<N>.lvl instead of level N when the file exists
+const char* const LEVEL_FILE_DIR = "levels";
+
+// "levels/level3.lvl"
+std::string levelFilePath(const std::string& directory, int levelNumber);
+
+// Grid geometry shared by grid levels and the generator. The lot is exactly
+// columns x rows cells; cars are inset from their cells by a gap.
+LotLayout gridLot(int columns, int rows, float cell);
+
+// A car covering `length` cells from (row, column), sliding the whole row or
+// column; colorIndex picks from the grid palette (the target is always red).
+// The target may drive one cell past the right edge.
+Car gridCar(const LotLayout& lot, int row, int column, int length, bool vertical, bool target, int colorIndex);
+Car gridWall(const LotLayout& lot, int row, int column);
+
+// Puts the exit in the target's row, halfway into the cell past the edge
+void placeGridExit(LotLayout& lot, const Car& target);
+
+// Appends the cars and ramps of a character grid (the body of a `grid`
+// directive) for `floor` to `level` and fits its lot to the grid; false with
+// the reason in `error` if the grid is malformed
+bool gridLevelCars(const std::vector<std::string>& rows, float cell, int floor, LevelSetup& level,
+                   std::string& error);
+
+bool loadLevelFile(const std::string& path, LevelSetup& level);
+bool saveLevelFile(const std::string& path, const LevelSetup& level);
@@ -1,25 +1,41 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <fstream>
 #include <map>
+#include <memory>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "board.h"
+#include "car.h"
+#include "collision_grid.h"
+#include "distance_db.h"
+#include "hint_engine.h"
+#include "input_latency.h"
+#include "level_pack.h"
+#include "level_streamer.h"
+#include "level_watcher.h"
+#include "levels.h"
+
 // Screen dimensions
 const unsigned int SCR_WIDTH = 1200;
 const unsigned int SCR_HEIGHT = 800;
 
-// Camera settings
+// Camera settings; frameLot() pulls the camera back for lots bigger than 12x12
 glm::vec3 cameraPos = glm::vec3(0.0f, 10.0f, 15.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, -0.6f, -0.8f);
 glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+float cameraNear = 0.1f;
+float cameraFar = 100.0f;
 
 // Game state
 enum GameState { MENU, LEVEL_SELECT, PLAYING, PAUSED, GAME_OVER, WIN };
@@ -29,7 +45,20 @@ float gameTime = 120.0f;
 int moveCount = 0;
 int selectedCarIndex = -1;
 int currentLevel = 1;
-int totalLevels = 3;
+int totalLevels = BUILTIN_LEVEL_COUNT;
+// Levels come from LEVEL_PACK_FILE when it exists, else from levels.cpp
+LevelPack levelPack;
+
+bool loadLevelSetup(int level, LevelSetup& setup) {
+    // A file in LEVEL_FILE_DIR overrides the level, so layouts can be edited while playing
+    std::string path = levelFilePath(LEVEL_FILE_DIR, level);
+    if (std::ifstream(path).good()) return loadLevelFile(path, setup);
+    return levelPack.isOpen() ? levelPack.load(level - 1, setup) : setupBuiltinLevel(level, setup);
+}
+
+// Prepares the level after the one being played
+std::unique_ptr<LevelStreamer> levelStreamer;
+LevelWatcher levelWatcher;
 
 // Mouse state
 double mouseX, mouseY;
@@ -44,6 +73,18 @@ bool rightPressed = false;
 // Collision penalty tracker
 float collisionCooldown = 0.0f;
 
+// Key press -> presented frame latency (F3 dumps the histogram)
+InputLatencyTracker inputLatency;
+
+// Late latch: sample input after the static scene is recorded (L toggles)
+bool lateLatchEnabled = false;
+
+// Background hint search (H); the HUD shows THINKING until it answers
+std::unique_ptr<HintEngine> hintEngine;
+bool hintRequested = false;
+int hintedCarIndex = -1;
+std::string hintText;
+
 // Menu button structure
 struct Button {
     float x, y, width, height;
@@ -94,31 +135,31 @@ std::map<char, std::vector<std::vector<int>>> fontData = {
     {'Y', {{1,0,0,0,1}, {1,0,0,0,1}, {0,1,0,1,0}, {0,0,1,0,0}, {0,0,1,0,0}, {0,0,1,0,0}, {0,0,1,0,0}}},
 };
 
-// Vertex shader source
-const char* vertexShaderSource = R"(
+const char* fragmentShaderSource = R"(
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
-
-out vec3 ourColor;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+out vec4 FragColor;
+in vec3 ourColor;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    ourColor = aColor;
+    FragColor = vec4(ourColor, 1.0);
 }
 )";
 
-const char* fragmentShaderSource = R"(
+const char* carVertexShaderSource = R"(
 #version 330 core
-out vec4 FragColor;
-in vec3 ourColor;
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec3 iOffset;
+layout (location = 3) in vec3 iScale;
+layout (location = 4) in vec3 iColor;
+
+out vec3 ourColor;
+
+uniform mat4 view;
+uniform mat4 projection;
 
 void main() {
-    FragColor = vec4(ourColor, 1.0);
+    gl_Position = projection * view * vec4(aPos * iScale + iOffset, 1.0);
+    ourColor = iColor;
 }
 )";
 
@@ -229,86 +270,191 @@ float cubeVertices[] = {
     -0.5f,  0.5f, -0.5f,  0.9f, 0.3f, 0.3f
 };
 
-struct Car {
-    glm::vec3 position;
-    glm::vec3 size;
-    glm::vec3 baseColor;
-    bool isVertical;
-    bool isTarget;
-    int id;
-    float minPos;
-    float maxPos;
-};
-
 std::vector<Car> cars;
 
-void setupLevel1() {
-    cars.clear();
-    gameTime = 120.0f;
-    score = 1000;
-    moveCount = 0;
+// The current level's lot and ramps, and the per-floor bucket grids
+// checkCollision searches
+LotLayout liveLot;
+std::vector<Ramp> liveRamps;
+GarageCollision liveCollision;
+// cars is grouped by floor: floor f is [liveFloorStart[f], liveFloorStart[f + 1]).
+// Garage levels are played one floor at a time; only viewedFloor is drawn.
+std::vector<int> liveFloorStart(2, 0);
+int viewedFloor = 0;
+// Set when the level's cars or lot are replaced; the render loop then rebuilds
+// the lot and car instance buffers instead of patching single cars
+bool sceneStale = true;
+
+// Discretized view of the live level; liveBoardHash is the Zobrist hash the
+// solvers use for the same state, kept up to date one slot change at a time
+Board liveBoard;
+bool liveBoardValid = false;
+ZobristTable liveZobrist;
+BoardState liveSlots;
+uint64_t liveBoardHash = 0;
+
+// Offline distance table for the level (ParkingJamSolver --write-db), if shipped;
+// liveMovesLeft is -1 when the current state is not in it
+std::unique_ptr<DistanceDatabase> liveDistances;
+BoardKey liveBoardKey;
+int liveMovesLeft = -1;
+
+void updateMovesLeft() {
+    int distance;
+    if (liveDistances && liveDistances->lookup(liveBoardKey, distance)) {
+        liveMovesLeft = distance;
+    } else {
+        liveMovesLeft = -1;
+    }
+}
+
+// Takes over the board, keys and distance table built by prepareLevel
+void adoptLiveBoard(PreparedLevel& level) {
+    hintRequested = false;
+    liveMovesLeft = -1;
+    liveBoardValid = level.boardValid;
+    liveBoard = std::move(level.board);
+    liveZobrist = std::move(level.zobrist);
+    liveSlots = std::move(level.startSlots);
+    liveBoardHash = level.startHash;
+    liveBoardKey = level.startKey;
+    liveDistances = std::move(level.distances);
+    if (!liveBoardValid) return;
     
-    cars.push_back({glm::vec3(-3.0f, 0.4f, 0.0f), glm::vec3(2.5f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 0.0f, 0.0f), false, true, 0, -5.0f, 6.5f});
-    cars.push_back({glm::vec3(1.0f, 0.4f, 2.5f), glm::vec3(1.2f, 0.8f, 2.5f), 
-                    glm::vec3(0.2f, 0.5f, 1.0f), true, false, 1, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(3.0f, 0.4f, -1.0f), glm::vec3(1.2f, 0.8f, 3.0f), 
-                    glm::vec3(0.2f, 1.0f, 0.5f), true, false, 2, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(-1.5f, 0.4f, -3.0f), glm::vec3(2.0f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 1.0f, 0.2f), false, false, 3, -5.0f, 5.0f});
+    if (liveDistances) {
+        std::cout << "Loaded " << liveDistances->size() << " precomputed states for level " << level.number
+                  << std::endl;
+        updateMovesLeft();
+    }
+    if (hintEngine) hintEngine->setBoard(liveBoard, liveDistances.get());
 }
 
-void setupLevel2() {
-    cars.clear();
-    gameTime = 150.0f;
-    score = 1500;
-    moveCount = 0;
+void updateLiveBoardSlot(int carIndex) {
+    if (!liveBoardValid) return;
+    const Car& car = cars[carIndex];
+    int slot = boardSlotForPosition(liveBoard, carIndex, car.isVertical ? car.position.z : car.position.x);
+    if (slot != liveSlots[carIndex]) {
+        liveBoardHash = zobristMove(liveZobrist, liveBoardHash, carIndex, liveSlots[carIndex], slot);
+        updateBoardKey(liveBoard, liveBoardKey, carIndex, liveSlots[carIndex], slot);
+        liveSlots[carIndex] = (uint8_t)slot;
+        updateMovesLeft();
+        // The old search no longer matters; a cached hint for the new state still shows
+        if (hintEngine) hintEngine->cancel();
+    }
+}
+
+void requestHint() {
+    if (!liveBoardValid || !hintEngine) return;
+    hintEngine->request(liveSlots, liveBoardHash);
+    hintRequested = true;
+}
+
+// Refreshes hintedCarIndex / hintText from the engine for the current state
+void updateHintDisplay() {
+    hintedCarIndex = -1;
+    hintText.clear();
+    if (!hintRequested || !liveBoardValid) return;
     
-    cars.push_back({glm::vec3(-4.0f, 0.4f, 0.0f), glm::vec3(2.5f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 0.0f, 0.0f), false, true, 0, -5.0f, 6.5f});
-    cars.push_back({glm::vec3(0.0f, 0.4f, 2.0f), glm::vec3(1.2f, 0.8f, 2.5f), 
-                    glm::vec3(0.2f, 0.5f, 1.0f), true, false, 1, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(2.5f, 0.4f, 0.0f), glm::vec3(1.2f, 0.8f, 3.0f), 
-                    glm::vec3(0.2f, 1.0f, 0.5f), true, false, 2, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(-2.0f, 0.4f, -2.5f), glm::vec3(2.0f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 1.0f, 0.2f), false, false, 3, -5.0f, 5.0f});
-    cars.push_back({glm::vec3(-3.5f, 0.4f, 3.0f), glm::vec3(1.2f, 0.8f, 2.0f), 
-                    glm::vec3(1.0f, 0.5f, 0.0f), true, false, 4, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(4.0f, 0.4f, -3.0f), glm::vec3(1.2f, 0.8f, 2.0f), 
-                    glm::vec3(0.5f, 0.0f, 1.0f), true, false, 5, -4.0f, 4.0f});
-}
-
-void setupLevel3() {
-    cars.clear();
-    gameTime = 180.0f;
-    score = 2000;
+    Hint hint;
+    HintEngine::Status status = hintEngine->poll(liveBoardHash, hint);
+    if (status == HintEngine::IDLE) {
+        hintRequested = false;
+    } else if (status == HintEngine::THINKING) {
+        hintText = "THINKING";
+    } else if (status == HintEngine::NO_HINT) {
+        hintText = "NO HINT YET";
+    } else if (!hint.solvable) {
+        hintText = "NO SOLUTION";
+    } else if (hint.car >= 0) {
+        const char* direction;
+        if (liveBoard.cars[hint.car].vertical) {
+            direction = hint.delta < 0 ? "UP" : "DOWN";
+        } else {
+            direction = hint.delta < 0 ? "LEFT" : "RIGHT";
+        }
+        std::stringstream ss;
+        ss << "HINT CAR " << (hint.car + 1) << " " << direction;
+        hintText = ss.str();
+        hintedCarIndex = hint.car;
+    }
+}
+
+int liveFloorCount() {
+    return (int)liveFloorStart.size() - 1;
+}
+
+// The camera rises with the floor, looking at it the way it looks at the ground
+void frameLot(const LotLayout& lot, int floor) {
+    float scale = std::max(1.0f, std::max(lot.width, lot.depth) / 12.0f);
+    cameraPos = glm::vec3(0.0f, 10.0f, 15.0f) * scale + glm::vec3(0.0f, floor * FLOOR_HEIGHT, 0.0f);
+    cameraNear = 0.1f * scale;
+    cameraFar = 100.0f * scale;
+}
+
+void viewFloor(int floor) {
+    viewedFloor = std::max(0, std::min(floor, liveFloorCount() - 1));
+    frameLot(liveLot, viewedFloor);
+}
+
+// Selecting a car on another floor takes the view there
+void selectCar(int carIndex) {
+    selectedCarIndex = carIndex;
+    if (carIndex >= 0 && carIndex < (int)cars.size() && carFloor(cars[carIndex]) != viewedFloor) {
+        viewFloor(carFloor(cars[carIndex]));
+    }
+}
+
+void startPreparedLevel(PreparedLevel& prepared) {
+    cars = std::move(prepared.setup.cars);
+    liveLot = prepared.setup.lot;
+    liveRamps = std::move(prepared.setup.ramps);
+    liveCollision = std::move(prepared.collision);
+    liveFloorStart = std::move(prepared.floorStart);
+    viewFloor(0);
+    sceneStale = true;
+    gameTime = prepared.setup.gameTime;
+    score = prepared.setup.score;
     moveCount = 0;
-    
-    cars.push_back({glm::vec3(-4.5f, 0.4f, 0.0f), glm::vec3(2.5f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 0.0f, 0.0f), false, true, 0, -5.0f, 6.5f});
-    cars.push_back({glm::vec3(-1.0f, 0.4f, 2.0f), glm::vec3(1.2f, 0.8f, 2.5f), 
-                    glm::vec3(0.2f, 0.5f, 1.0f), true, false, 1, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(1.5f, 0.4f, 0.5f), glm::vec3(1.2f, 0.8f, 3.0f), 
-                    glm::vec3(0.2f, 1.0f, 0.5f), true, false, 2, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(-2.5f, 0.4f, -2.5f), glm::vec3(2.0f, 0.8f, 1.2f), 
-                    glm::vec3(1.0f, 1.0f, 0.2f), false, false, 3, -5.0f, 5.0f});
-    cars.push_back({glm::vec3(-3.5f, 0.4f, 3.5f), glm::vec3(1.2f, 0.8f, 2.0f), 
-                    glm::vec3(1.0f, 0.5f, 0.0f), true, false, 4, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(4.0f, 0.4f, -2.0f), glm::vec3(1.2f, 0.8f, 2.5f), 
-                    glm::vec3(0.5f, 0.0f, 1.0f), true, false, 5, -4.0f, 4.0f});
-    cars.push_back({glm::vec3(1.0f, 0.4f, -4.0f), glm::vec3(2.5f, 0.8f, 1.2f), 
-                    glm::vec3(0.0f, 0.8f, 0.8f), false, false, 6, -5.0f, 5.0f});
+    selectCar(0);
+    adoptLiveBoard(prepared);
 }
 
 void loadLevel(int level) {
     currentLevel = level;
-    switch(level) {
-        case 1: setupLevel1(); break;
-        case 2: setupLevel2(); break;
-        case 3: setupLevel3(); break;
-        default: setupLevel1(); break;
+    PreparedLevel prepared;
+    // The next level is normally ready already; anything else is prepared here
+    if (!levelStreamer || !levelStreamer->take(level, prepared)) {
+        if (!loadLevelSetup(level, prepared.setup)) {
+            setupBuiltinLevel(1, prepared.setup);
+        }
+        prepareLevel(level, prepared);
+    }
+    startPreparedLevel(prepared);
+    
+    if (levelStreamer && level < totalLevels) levelStreamer->prefetch(level + 1);
+}
+
+// Hot reload: re-reads only the levels whose files changed. The level being
+// played restarts with the new layout; a broken file keeps the old one.
+void reloadChangedLevels() {
+    static std::vector<int> changed;
+    levelWatcher.poll(changed);
+    for (int level : changed) {
+        if (levelStreamer) levelStreamer->invalidate(level);
+        bool inLevel = gameState == PLAYING || gameState == PAUSED || gameState == WIN || gameState == GAME_OVER;
+        if (level != currentLevel || !inLevel) continue;
+
+        PreparedLevel prepared;
+        if (!loadLevelSetup(level, prepared.setup)) {
+            std::cout << "Level " << level << " did not load; keeping the current layout" << std::endl;
+            continue;
+        }
+        prepareLevel(level, prepared);
+        startPreparedLevel(prepared);
+        // A finished level restarts like R does; a paused one stays paused
+        if (gameState == WIN || gameState == GAME_OVER) gameState = PLAYING;
+        std::cout << "Level " << level << " reloaded" << std::endl;
     }
-    selectedCarIndex = 0;
 }
 
 void setupMenuButtons() {
@@ -323,109 +469,41 @@ void setupPauseButtons() {
     pauseButtons.push_back({400, 420, 400, 80, "MAIN MENU", false, 1});
 }
 
+// The level menu shows one page of a pack at a time: two rows of five
+const int LEVELS_PER_PAGE = 10;
+const int LEVEL_BUTTON_PREV = -2;
+const int LEVEL_BUTTON_NEXT = -3;
+int levelPage = 0;
+
 void setupLevelButtons() {
     levelButtons.clear();
-    levelButtons.push_back({300, 250, 200, 100, "LEVEL 1", false, 1});
-    levelButtons.push_back({550, 250, 200, 100, "LEVEL 2", false, 2});
-    levelButtons.push_back({800, 250, 200, 100, "LEVEL 3", false, 3});
-    levelButtons.push_back({400, 450, 400, 80, "BACK", false, 0});
+    int first = levelPage * LEVELS_PER_PAGE + 1;
+    for (int i = 0; i < LEVELS_PER_PAGE && first + i <= totalLevels; i++) {
+        float x = 70.0f + (i % 5) * 215.0f;
+        float y = 200.0f + (i / 5) * 150.0f;
+        levelButtons.push_back({x, y, 200, 90, "LEVEL " + std::to_string(first + i), false, first + i});
+    }
+    if (levelPage > 0) levelButtons.push_back({70, 500, 200, 80, "PREV", false, LEVEL_BUTTON_PREV});
+    if (first + LEVELS_PER_PAGE <= totalLevels) {
+        levelButtons.push_back({930, 500, 200, 80, "NEXT", false, LEVEL_BUTTON_NEXT});
+    }
+    levelButtons.push_back({400, 500, 400, 80, "BACK", false, 0});
 }
 
 bool checkCollision(int carIndex, glm::vec3 newPos) {
-    Car& car = cars[carIndex];
-    
-    for (size_t i = 0; i < cars.size(); i++) {
-        if (i == carIndex) continue;
-        
-        const Car& other = cars[i];
-        
-        bool collisionX = (newPos.x - car.size.x/2 < other.position.x + other.size.x/2) &&
-                         (newPos.x + car.size.x/2 > other.position.x - other.size.x/2);
-        
-        bool collisionZ = (newPos.z - car.size.z/2 < other.position.z + other.size.z/2) &&
-                         (newPos.z + car.size.z/2 > other.position.z - other.size.z/2);
-        
-        if (collisionX && collisionZ) {
-            return true;
-        }
-    }
-    
-    return false;
+    return liveCollision.collides(cars, carIndex, newPos);
 }
 
-void drawCube(unsigned int shaderProgram, unsigned int VAO, glm::mat4 model) {
-    unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-}
+// Per-instance data for the instanced car pass: body + 4 wheels per car
+struct CarInstance {
+    glm::vec3 offset;
+    glm::vec3 scale;
+    glm::vec3 color;
+};
 
-void drawParkingLot(unsigned int shaderProgram, unsigned int VAO, unsigned int colorVBO) {
-    float groundColor[] = {0.3f, 0.3f, 0.35f};
-    
-    std::vector<float> groundVertices;
-    for (int i = 0; i < 36; i++) {
-        groundVertices.push_back(cubeVertices[i * 6]);
-        groundVertices.push_back(cubeVertices[i * 6 + 1]);
-        groundVertices.push_back(cubeVertices[i * 6 + 2]);
-        groundVertices.push_back(groundColor[0]);
-        groundVertices.push_back(groundColor[1]);
-        groundVertices.push_back(groundColor[2]);
-    }
-    
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, groundVertices.size() * sizeof(float), groundVertices.data());
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-    model = glm::scale(model, glm::vec3(12.0f, 0.1f, 12.0f));
-    drawCube(shaderProgram, VAO, model);
-    
-    float lineColor[] = {0.9f, 0.9f, 0.9f};
-    std::vector<float> lineVertices;
-    for (int i = 0; i < 36; i++) {
-        lineVertices.push_back(cubeVertices[i * 6]);
-        lineVertices.push_back(cubeVertices[i * 6 + 1]);
-        lineVertices.push_back(cubeVertices[i * 6 + 2]);
-        lineVertices.push_back(lineColor[0]);
-        lineVertices.push_back(lineColor[1]);
-        lineVertices.push_back(lineColor[2]);
-    }
-    glBufferSubData(GL_ARRAY_BUFFER, 0, lineVertices.size() * sizeof(float), lineVertices.data());
-    
-    for (int i = -5; i <= 5; i++) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.06f, i * 1.2f));
-        model = glm::scale(model, glm::vec3(11.0f, 0.01f, 0.05f));
-        drawCube(shaderProgram, VAO, model);
-    }
-    
-    for (int i = -5; i <= 5; i++) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(i * 1.2f, 0.06f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.05f, 0.01f, 11.0f));
-        drawCube(shaderProgram, VAO, model);
-    }
-    
-    float exitColor[] = {0.2f, 0.8f, 0.2f};
-    std::vector<float> exitVertices;
-    for (int i = 0; i < 36; i++) {
-        exitVertices.push_back(cubeVertices[i * 6]);
-        exitVertices.push_back(cubeVertices[i * 6 + 1]);
-        exitVertices.push_back(cubeVertices[i * 6 + 2]);
-        exitVertices.push_back(exitColor[0]);
-        exitVertices.push_back(exitColor[1]);
-        exitVertices.push_back(exitColor[2]);
-    }
-    glBufferSubData(GL_ARRAY_BUFFER, 0, exitVertices.size() * sizeof(float), exitVertices.data());
-    
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(5.8f, 0.06f, 0.0f));
-    model = glm::scale(model, glm::vec3(0.3f, 0.02f, 2.0f));
-    drawCube(shaderProgram, VAO, model);
-}
+const int INSTANCES_PER_CAR = 5;
 
-void drawCar(unsigned int shaderProgram, unsigned int VAO, unsigned int colorVBO, const Car& car, bool isSelected) {
+void buildCarInstances(const Car& car, bool isSelected, bool isHinted, CarInstance* out) {
     glm::vec3 color = car.baseColor;
     
     if (isSelected) {
@@ -436,36 +514,13 @@ void drawCar(unsigned int shaderProgram, unsigned int VAO, unsigned int colorVBO
         );
     }
     
-    std::vector<float> carVertices;
-    for (int i = 0; i < 36; i++) {
-        carVertices.push_back(cubeVertices[i * 6]);
-        carVertices.push_back(cubeVertices[i * 6 + 1]);
-        carVertices.push_back(cubeVertices[i * 6 + 2]);
-        carVertices.push_back(color.r);
-        carVertices.push_back(color.g);
-        carVertices.push_back(color.b);
+    if (isHinted) {
+        color = color * 0.5f + glm::vec3(0.0f, 0.5f, 0.0f);
     }
     
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, carVertices.size() * sizeof(float), carVertices.data());
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, car.position);
-    model = glm::scale(model, car.size);
-    drawCube(shaderProgram, VAO, model);
-    
-    float wheelColor[] = {0.1f, 0.1f, 0.1f};
-    std::vector<float> wheelVertices;
-    for (int i = 0; i < 36; i++) {
-        wheelVertices.push_back(cubeVertices[i * 6]);
-        wheelVertices.push_back(cubeVertices[i * 6 + 1]);
-        wheelVertices.push_back(cubeVertices[i * 6 + 2]);
-        wheelVertices.push_back(wheelColor[0]);
-        wheelVertices.push_back(wheelColor[1]);
-        wheelVertices.push_back(wheelColor[2]);
-    }
-    glBufferSubData(GL_ARRAY_BUFFER, 0, wheelVertices.size() * sizeof(float), wheelVertices.data());
+    out[0] = {car.position, car.size, color};
     
+    glm::vec3 wheelColor = glm::vec3(0.1f, 0.1f, 0.1f);
     float wheelSize = 0.25f;
     float wheelOffset = car.isVertical ? car.size.z * 0.35f : car.size.x * 0.35f;
     float wheelHeight = -car.size.y * 0.35f;
@@ -484,11 +539,144 @@ void drawCar(unsigned int shaderProgram, unsigned int VAO, unsigned int colorVBO
     }
     
     for (int i = 0; i < 4; i++) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, wheelPositions[i]);
-        model = glm::scale(model, glm::vec3(wheelSize, wheelSize, wheelSize));
-        drawCube(shaderProgram, VAO, model);
+        out[1 + i] = {wheelPositions[i], glm::vec3(wheelSize, wheelSize, wheelSize), wheelColor};
+    }
+}
+
+// Fills and uploads the instance buffer for every car
+void uploadCarInstances(unsigned int instanceVBO, std::vector<CarInstance>& instances, size_t& capacity) {
+    instances.resize(cars.size() * INSTANCES_PER_CAR);
+    for (size_t i = 0; i < cars.size(); i++) {
+        buildCarInstances(cars[i], (int)i == selectedCarIndex, (int)i == hintedCarIndex,
+                          &instances[i * INSTANCES_PER_CAR]);
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instances.size() > capacity) {
+        capacity = instances.size();
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(CarInstance), instances.data(), GL_DYNAMIC_DRAW);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(CarInstance), instances.data());
+    }
+}
+
+// Grows the instance buffer while the previous level is still being played,
+// so the first frame of a bigger prefetched level does not reallocate it. The
+// level on screen is copied into the new storage: refreshCarInstances only
+// patches the cars that changed.
+void reserveCarInstances(unsigned int instanceVBO, const std::vector<CarInstance>& instances, size_t carCount,
+                         size_t& capacity) {
+    size_t needed = carCount * INSTANCES_PER_CAR;
+    if (needed <= capacity) return;
+    capacity = needed;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(CarInstance), NULL, GL_DYNAMIC_DRAW);
+    if (!instances.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(CarInstance), instances.data());
+    }
+}
+
+// Rewrites a single car's slice of the instance buffer (late-latch patch)
+void patchCarInstance(unsigned int instanceVBO, std::vector<CarInstance>& instances, int carIndex) {
+    if (carIndex < 0 || carIndex >= (int)cars.size()) return;
+    // A level started mid-frame has not been uploaded yet; the next frame uploads it whole
+    if ((size_t)(carIndex + 1) * INSTANCES_PER_CAR > instances.size()) return;
+    
+    CarInstance* slice = &instances[carIndex * INSTANCES_PER_CAR];
+    buildCarInstances(cars[carIndex], carIndex == selectedCarIndex, carIndex == hintedCarIndex, slice);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, carIndex * INSTANCES_PER_CAR * sizeof(CarInstance),
+                    INSTANCES_PER_CAR * sizeof(CarInstance), slice);
+}
+
+// Cars whose instances were last built as selected / hinted, -1 = none
+int instancedSelected = -1;
+int instancedHinted = -1;
+
+// Only the selected car moves, and only the selection and the hint change a
+// car's color, so after a full upload at level start each frame patches at
+// most four cars, however many the level has
+void refreshCarInstances(unsigned int instanceVBO, std::vector<CarInstance>& instances, size_t& capacity) {
+    if (sceneStale || instances.size() != cars.size() * INSTANCES_PER_CAR) {
+        uploadCarInstances(instanceVBO, instances, capacity);
+    } else {
+        int touched[] = {instancedSelected, instancedHinted, selectedCarIndex, hintedCarIndex};
+        for (int i = 0; i < 4; i++) {
+            if (std::find(touched, touched + i, touched[i]) == touched + i) {
+                patchCarInstance(instanceVBO, instances, touched[i]);
+            }
+        }
     }
+    instancedSelected = selectedCarIndex;
+    instancedHinted = hintedCarIndex;
+}
+
+// Draws instances [first, first + count) of the VAO's instance buffer. GL 3.3
+// has no base instance, so the per-instance attributes are re-pointed at `first`.
+void drawCarInstances(unsigned int carShader, unsigned int carVAO, unsigned int instanceVBO, size_t first,
+                      size_t count) {
+    glUseProgram(carShader);
+    glBindVertexArray(carVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int attr = 0; attr < 3; attr++) {
+        glVertexAttribPointer(2 + attr, 3, GL_FLOAT, GL_FALSE, sizeof(CarInstance),
+                              (void*)(first * sizeof(CarInstance) + attr * sizeof(glm::vec3)));
+    }
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)count);
+}
+
+// Per floor: the slab, the grid lines on every cell edge, the ramps and (on
+// the ground floor) the exit marker, as cube instances so any size of lot is
+// one draw. Floor f's instances are [floorStart[f], floorStart[f + 1]).
+void buildLotInstances(const LotLayout& lot, const std::vector<Ramp>& ramps, int floors,
+                       std::vector<CarInstance>& instances, std::vector<size_t>& floorStart) {
+    instances.clear();
+    floorStart.clear();
+    glm::vec3 lineColor = glm::vec3(0.9f, 0.9f, 0.9f);
+    glm::vec3 rampColor = glm::vec3(0.8f, 0.5f, 0.2f);
+    int columns = lot.cell > 0.0f ? (int)std::lround(lot.width / lot.cell) : 0;
+    int rows = lot.cell > 0.0f ? (int)std::lround(lot.depth / lot.cell) : 0;
+    for (int floor = 0; floor < floors; floor++) {
+        floorStart.push_back(instances.size());
+        float y = floor * FLOOR_HEIGHT;
+        instances.push_back({glm::vec3(0.0f, y, 0.0f), glm::vec3(lot.width, 0.1f, lot.depth),
+                             glm::vec3(0.3f, 0.3f, 0.35f)});
+        
+        for (int i = 0; i <= rows; i++) {
+            float z = -0.5f * lot.depth + i * lot.cell;
+            instances.push_back({glm::vec3(0.0f, y + 0.06f, z), glm::vec3(lot.width - 1.0f, 0.01f, 0.05f),
+                                 lineColor});
+        }
+        for (int i = 0; i <= columns; i++) {
+            float x = -0.5f * lot.width + i * lot.cell;
+            instances.push_back({glm::vec3(x, y + 0.06f, 0.0f), glm::vec3(0.05f, 0.01f, lot.depth - 1.0f),
+                                 lineColor});
+        }
+        
+        // Ramps up from this floor and down from it look the same
+        for (const Ramp& ramp : ramps) {
+            if (ramp.floor != floor && ramp.floor != floor - 1) continue;
+            glm::vec3 center(0.5f * (ramp.x0 + ramp.x1), y + 0.07f, 0.5f * (ramp.z0 + ramp.z1));
+            instances.push_back({center, glm::vec3(ramp.x1 - ramp.x0, 0.02f, ramp.z1 - ramp.z0), rampColor});
+        }
+        
+        if (floor == 0) {
+            instances.push_back({glm::vec3(0.5f * lot.width - 0.2f, 0.06f, lot.exitZ),
+                                 glm::vec3(0.3f, 0.02f, lot.exitWidth), glm::vec3(0.2f, 0.8f, 0.2f)});
+        }
+    }
+    floorStart.push_back(instances.size());
+}
+
+void uploadLotInstances(unsigned int lotInstanceVBO, const std::vector<CarInstance>& instances) {
+    glBindBuffer(GL_ARRAY_BUFFER, lotInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CarInstance), instances.data(), GL_STATIC_DRAW);
+}
+
+void drawParkingLot(unsigned int carShader, unsigned int lotVAO, unsigned int lotInstanceVBO,
+                    const std::vector<size_t>& floorStart, int floor) {
+    drawCarInstances(carShader, lotVAO, lotInstanceVBO, floorStart[floor], floorStart[floor + 1] - floorStart[floor]);
 }
 
 void drawRect(unsigned int shader2D, unsigned int VAO2D, unsigned int VBO2D, 
@@ -594,7 +782,10 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             int clicked = checkButtonClick(levelButtons, mouseX, mouseY);
             if (clicked == 0) {
                 gameState = MENU;
-            } else if (clicked >= 1 && clicked <= 3) {
+            } else if (clicked == LEVEL_BUTTON_PREV || clicked == LEVEL_BUTTON_NEXT) {
+                levelPage += clicked == LEVEL_BUTTON_NEXT ? 1 : -1;
+                setupLevelButtons();
+            } else if (clicked >= 1 && clicked <= totalLevels) {
                 loadLevel(clicked);
                 gameState = PLAYING;
                 std::cout << "Starting Level " << clicked << std::endl;
@@ -632,6 +823,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         if (key == GLFW_KEY_LEFT) leftPressed = true;
         if (key == GLFW_KEY_RIGHT) rightPressed = true;
         
+        if (gameState == PLAYING &&
+            (key == GLFW_KEY_UP || key == GLFW_KEY_DOWN || key == GLFW_KEY_LEFT || key == GLFW_KEY_RIGHT)) {
+            inputLatency.onInput(key, glfwGetTime());
+        }
+        
+        if (key == GLFW_KEY_F3) {
+            inputLatency.dumpStats(std::cout);
+        }
+        
+        if (key == GLFW_KEY_L) {
+            lateLatchEnabled = !lateLatchEnabled;
+            std::cout << "Late latch " << (lateLatchEnabled ? "ON" : "OFF") << std::endl;
+        }
+        
         if (key == GLFW_KEY_P && gameState == PLAYING) {
             gameState = PAUSED;
             std::cout << "Game Paused" << std::endl;
@@ -643,16 +848,36 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         if (key >= GLFW_KEY_1 && key <= GLFW_KEY_9) {
             int carNum = key - GLFW_KEY_1;
             if (carNum < cars.size() && gameState == PLAYING) {
-                selectedCarIndex = carNum;
+                selectCar(carNum);
                 std::cout << "Selected Car " << (carNum + 1) << std::endl;
             }
         }
         
         if (key == GLFW_KEY_SPACE && gameState == PLAYING) {
-            selectedCarIndex = 0;
+            selectCar(0);
             std::cout << "Selected Target Car (RED)" << std::endl;
         }
         
+        // Garage levels: go up / down a floor and pick its first car
+        if ((key == GLFW_KEY_PAGE_UP || key == GLFW_KEY_PAGE_DOWN) && gameState == PLAYING) {
+            int floor = viewedFloor + (key == GLFW_KEY_PAGE_UP ? 1 : -1);
+            if (floor >= 0 && floor < liveFloorCount()) {
+                viewFloor(floor);
+                if (liveFloorStart[floor] < liveFloorStart[floor + 1]) selectCar(liveFloorStart[floor]);
+                std::cout << "Floor " << floor << std::endl;
+            }
+        }
+        
+        if (key == GLFW_KEY_H && gameState == PLAYING) {
+            requestHint();
+        }
+        
+        if (key == GLFW_KEY_N && gameState == WIN && currentLevel < totalLevels) {
+            loadLevel(currentLevel + 1);
+            gameState = PLAYING;
+            std::cout << "Starting Level " << currentLevel << std::endl;
+        }
+        
         if (key == GLFW_KEY_R && (gameState == WIN || gameState == GAME_OVER)) {
             loadLevel(currentLevel);
             gameState = PLAYING;
@@ -668,6 +893,15 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
 }
 
+// Slides a car along its lane axis (0 = x, 2 = z) by `step` per held key,
+// clamped to the lane; true if either key is held
+template <int LANE_AXIS>
+bool slideAlongLane(const Car& car, bool backward, bool forward, float step, glm::vec3& newPos) {
+    float delta = step * ((float)forward - (float)backward);
+    newPos[LANE_AXIS] = glm::clamp(newPos[LANE_AXIS] + delta, car.minPos, car.maxPos);
+    return backward || forward;
+}
+
 void processInput(GLFWwindow* window, float deltaTime) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         if (gameState == PLAYING) {
@@ -692,29 +926,8 @@ void processInput(GLFWwindow* window, float deltaTime) {
     Car& car = cars[selectedCarIndex];
     float moveSpeed = 3.0f * deltaTime;
     glm::vec3 newPos = car.position;
-    bool moved = false;
-    
-    if (car.isVertical) {
-        if (upPressed) {
-            newPos.z -= moveSpeed;
-            moved = true;
-        }
-        if (downPressed) {
-            newPos.z += moveSpeed;
-            moved = true;
-        }
-        newPos.z = glm::clamp(newPos.z, car.minPos, car.maxPos);
-    } else {
-        if (leftPressed) {
-            newPos.x -= moveSpeed;
-            moved = true;
-        }
-        if (rightPressed) {
-            newPos.x += moveSpeed;
-            moved = true;
-        }
-        newPos.x = glm::clamp(newPos.x, car.minPos, car.maxPos);
-    }
+    bool moved = car.isVertical ? slideAlongLane<2>(car, upPressed, downPressed, moveSpeed, newPos)
+                                : slideAlongLane<0>(car, leftPressed, rightPressed, moveSpeed, newPos);
     
     if (moved) {
         if (checkCollision(selectedCarIndex, newPos)) {
@@ -728,9 +941,12 @@ void processInput(GLFWwindow* window, float deltaTime) {
         } else {
             // No collision - move the car
             car.position = newPos;
+            liveCollision.update(cars, selectedCarIndex);
+            updateLiveBoardSlot(selectedCarIndex);
+            inputLatency.onSimulated(glfwGetTime());
             
             // Check win condition for target car
-            if (car.isTarget && car.position.x >= 5.5f) {
+            if (car.isTarget && car.position.x >= liveLot.exitX) {
                 gameState = WIN;
                 score += (int)(gameTime * 10);
                 std::cout << "LEVEL " << currentLevel << " COMPLETE! Final Score: " << score << std::endl;
@@ -771,21 +987,55 @@ int main() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    unsigned int shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    inputLatency.init();
+    hintEngine.reset(new HintEngine());
+
     unsigned int shader2D = createShaderProgram(vertex2DShaderSource, fragment2DShaderSource);
+    unsigned int carShader = createShaderProgram(carVertexShaderSource, fragmentShaderSource);
+
+    // Instanced car geometry: static cube + per-instance offset/scale/color
+    unsigned int carVAO, cubeVBO, instanceVBO;
+    glGenVertexArrays(1, &carVAO);
+    glGenBuffers(1, &cubeVBO);
+    glGenBuffers(1, &instanceVBO);
 
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    glBindVertexArray(carVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int attr = 0; attr < 3; attr++) {
+        glVertexAttribPointer(2 + attr, 3, GL_FLOAT, GL_FALSE, sizeof(CarInstance),
+                              (void*)(attr * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(2 + attr);
+        glVertexAttribDivisor(2 + attr, 1);
+    }
+
+    std::vector<CarInstance> carInstances;
+    size_t instanceCapacity = 0;
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_DYNAMIC_DRAW);
+    // The lot is drawn the same way from its own instance buffer
+    unsigned int lotVAO, lotInstanceVBO;
+    glGenVertexArrays(1, &lotVAO);
+    glGenBuffers(1, &lotInstanceVBO);
 
+    glBindVertexArray(lotVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, lotInstanceVBO);
+    for (int attr = 0; attr < 3; attr++) {
+        glVertexAttribPointer(2 + attr, 3, GL_FLOAT, GL_FALSE, sizeof(CarInstance),
+                              (void*)(attr * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(2 + attr);
+        glVertexAttribDivisor(2 + attr, 1);
+    }
+
+    std::vector<CarInstance> lotInstances;
+    std::vector<size_t> lotFloorStart;
 
     unsigned int VBO2D, VAO2D;
     glGenVertexArrays(1, &VAO2D);
@@ -800,17 +1050,32 @@ int main() {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    if (std::ifstream(LEVEL_PACK_FILE).good() && levelPack.open(LEVEL_PACK_FILE)) {
+        totalLevels = levelPack.size();
+        std::cout << "Loaded " << totalLevels << " levels from " << LEVEL_PACK_FILE << std::endl;
+    }
+
+    levelStreamer.reset(new LevelStreamer(loadLevelSetup));
+    if (levelWatcher.start(LEVEL_FILE_DIR, totalLevels)) {
+        std::cout << "Watching " << LEVEL_FILE_DIR << "/ for level edits" << std::endl;
+    }
+
     setupMenuButtons();
     setupPauseButtons();
     setupLevelButtons();
     
     std::cout << "=== 3D PARKING JAM - ENHANCED EDITION ===" << std::endl;
-    std::cout << "Features: 3 Levels, Score System with Penalties" << std::endl;
+    std::cout << "Features: Built-in Levels or a Level Pack, Score System with Penalties" << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "  SPACE or 1-9: Select car" << std::endl;
+    std::cout << "  PAGE UP/DOWN: Change floor (garage levels)" << std::endl;
     std::cout << "  Arrow Keys: Move selected car" << std::endl;
     std::cout << "  P or ESC: Pause/Menu" << std::endl;
     std::cout << "  R: Restart level (after win/lose)" << std::endl;
+    std::cout << "  N: Next level (after win)" << std::endl;
+    std::cout << "  F3: Dump input latency stats" << std::endl;
+    std::cout << "  L: Toggle late-latched input" << std::endl;
+    std::cout << "  H: Hint (next optimal move)" << std::endl;
     std::cout << "Score: -10 for each collision!" << std::endl;
     std::cout << "=========================================" << std::endl;
     
@@ -822,7 +1087,11 @@ int main() {
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window, deltaTime);
+        // In late-latch mode input is sampled after the static scene is recorded
+        bool lateLatch = lateLatchEnabled && gameState == PLAYING;
+        if (!lateLatch) {
+            processInput(window, deltaTime);
+        }
 
         if (gameState == PLAYING) {
             gameTime -= deltaTime;
@@ -833,27 +1102,48 @@ int main() {
             }
         }
 
+        reloadChangedLevels();
+        updateHintDisplay();
+
         glClearColor(0.15f, 0.2f, 0.25f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         if (gameState == PLAYING || gameState == PAUSED || gameState == WIN || gameState == GAME_OVER) {
-            glUseProgram(shaderProgram);
-
             glm::mat4 projection = glm::perspective(glm::radians(45.0f), 
                                                     (float)SCR_WIDTH / (float)SCR_HEIGHT, 
-                                                    0.1f, 100.0f);
+                                                    cameraNear, cameraFar);
             glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 
-            unsigned int projectionLoc = glGetUniformLocation(shaderProgram, "projection");
-            unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-            glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-
-            drawParkingLot(shaderProgram, VAO, VBO);
+            if (sceneStale) {
+                buildLotInstances(liveLot, liveRamps, liveFloorCount(), lotInstances, lotFloorStart);
+                uploadLotInstances(lotInstanceVBO, lotInstances);
+            }
             
-            for (size_t i = 0; i < cars.size(); i++) {
-                drawCar(shaderProgram, VAO, VBO, cars[i], i == selectedCarIndex);
+            int latchedCar = selectedCarIndex;
+            reserveCarInstances(instanceVBO, carInstances, levelStreamer->readyCarCount(), instanceCapacity);
+            refreshCarInstances(instanceVBO, carInstances, instanceCapacity);
+            sceneStale = false;
+            
+            if (lateLatch) {
+                // Only the selected car can move, so patch its slice (and the old
+                // selection's highlight) right before the draw is submitted
+                glfwPollEvents();
+                processInput(window, deltaTime);
+                patchCarInstance(instanceVBO, carInstances, latchedCar);
+                if (selectedCarIndex != latchedCar) {
+                    patchCarInstance(instanceVBO, carInstances, selectedCarIndex);
+                }
             }
+            
+            glUseProgram(carShader);
+            glUniformMatrix4fv(glGetUniformLocation(carShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(carShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+            // Only the viewed floor: its slab and its range of the (floor-grouped) cars
+            drawParkingLot(carShader, lotVAO, lotInstanceVBO, lotFloorStart, viewedFloor);
+            size_t firstCar = liveFloorStart[viewedFloor];
+            size_t floorCars = liveFloorStart[viewedFloor + 1] - firstCar;
+            drawCarInstances(carShader, carVAO, instanceVBO, firstCar * INSTANCES_PER_CAR,
+                             floorCars * INSTANCES_PER_CAR);
         }
 
         glDisable(GL_DEPTH_TEST);
@@ -881,9 +1171,19 @@ int main() {
                 drawButton(shader2D, VAO2D, VBO2D, btn);
             }
             
-            drawText(shader2D, VAO2D, VBO2D, "EASY", 365, 380, 2.5f, glm::vec3(0.5f, 1.0f, 0.5f));
-            drawText(shader2D, VAO2D, VBO2D, "MEDIUM", 595, 380, 2.5f, glm::vec3(1.0f, 1.0f, 0.5f));
-            drawText(shader2D, VAO2D, VBO2D, "HARD", 865, 380, 2.5f, glm::vec3(1.0f, 0.5f, 0.5f));
+            // Only the built-in levels come in a known order of difficulty
+            if (!levelPack.isOpen() && levelPage == 0) {
+                const std::string difficulty[] = {"EASY", "MEDIUM", "HARD"};
+                const glm::vec3 difficultyColor[] = {glm::vec3(0.5f, 1.0f, 0.5f), glm::vec3(1.0f, 1.0f, 0.5f),
+                                                     glm::vec3(1.0f, 0.5f, 0.5f)};
+                for (const auto& btn : levelButtons) {
+                    if (btn.id < 1 || btn.id > 3) continue;
+                    const std::string& label = difficulty[btn.id - 1];
+                    float labelX = btn.x + (btn.width - label.length() * 6 * 2.5f) / 2;
+                    drawText(shader2D, VAO2D, VBO2D, label, labelX, btn.y + btn.height + 12, 2.5f,
+                             difficultyColor[btn.id - 1]);
+                }
+            }
             
         } else if (gameState == PLAYING) {
             std::stringstream timeStr;
@@ -900,12 +1200,29 @@ int main() {
             levelStr << "LEVEL " << currentLevel;
             drawText(shader2D, VAO2D, VBO2D, levelStr.str(), 20, 120, 3.5f, glm::vec3(0.5f, 1.0f, 1.0f));
             
+            if (liveFloorCount() > 1) {
+                std::stringstream floorStr;
+                floorStr << "FLOOR " << viewedFloor;
+                drawText(shader2D, VAO2D, VBO2D, floorStr.str(), SCR_WIDTH - 220, 120, 3.0f,
+                         glm::vec3(0.8f, 0.5f, 0.2f));
+            }
+            
             std::stringstream carStr;
             carStr << "CAR " << (selectedCarIndex + 1);
             drawText(shader2D, VAO2D, VBO2D, carStr.str(), SCR_WIDTH - 220, 20, 4.0f, glm::vec3(0.5f, 1.0f, 0.5f));
             
             drawText(shader2D, VAO2D, VBO2D, "P PAUSE", SCR_WIDTH - 190, 70, 3.0f, glm::vec3(0.7f, 0.7f, 0.7f));
             
+            if (liveMovesLeft >= 0 && liveMovesLeft != DISTANCE_DB_UNSOLVABLE) {
+                std::stringstream movesLeftStr;
+                movesLeftStr << "MOVES LEFT " << liveMovesLeft;
+                drawText(shader2D, VAO2D, VBO2D, movesLeftStr.str(), 20, 170, 3.0f, glm::vec3(0.8f, 0.8f, 1.0f));
+            }
+            
+            if (!hintText.empty()) {
+                drawText(shader2D, VAO2D, VBO2D, hintText, 20, SCR_HEIGHT - 60, 3.5f, glm::vec3(0.4f, 1.0f, 0.4f));
+            }
+            
         } else if (gameState == PAUSED) {
             drawRect(shader2D, VAO2D, VBO2D, 0, 0, SCR_WIDTH, SCR_HEIGHT, glm::vec3(0.0f, 0.0f, 0.0f));
             
@@ -924,6 +1241,9 @@ int main() {
             
             drawText(shader2D, VAO2D, VBO2D, "R TO RESTART", 400, 480, 3.0f, glm::vec3(0.8f, 0.8f, 0.8f));
             drawText(shader2D, VAO2D, VBO2D, "ESC TO MENU", 410, 520, 3.0f, glm::vec3(0.8f, 0.8f, 0.8f));
+            if (currentLevel < totalLevels) {
+                drawText(shader2D, VAO2D, VBO2D, "N TO CONTINUE", 395, 560, 3.0f, glm::vec3(0.8f, 0.8f, 0.8f));
+            }
             
         } else if (gameState == GAME_OVER) {
             drawText(shader2D, VAO2D, VBO2D, "GAME OVER", 330, 200, 7.0f, glm::vec3(1.0f, 0.0f, 0.0f));
@@ -938,16 +1258,27 @@ int main() {
 
         glEnable(GL_DEPTH_TEST);
 
+        inputLatency.onSubmit(glfwGetTime());
         glfwSwapBuffers(window);
+        inputLatency.onSwapped(glfwGetTime());
+        inputLatency.poll();
         glfwPollEvents();
     }
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    inputLatency.dumpStats(std::cout);
+    inputLatency.shutdown();
+    hintEngine.reset();
+    levelStreamer.reset();
+
+    glDeleteVertexArrays(1, &lotVAO);
+    glDeleteBuffers(1, &lotInstanceVBO);
+    glDeleteVertexArrays(1, &carVAO);
+    glDeleteBuffers(1, &cubeVBO);
+    glDeleteBuffers(1, &instanceVBO);
     glDeleteVertexArrays(1, &VAO2D);
     glDeleteBuffers(1, &VBO2D);
-    glDeleteProgram(shaderProgram);
     glDeleteProgram(shader2D);
+    glDeleteProgram(carShader);
 
     glfwTerminate();
     return 0;
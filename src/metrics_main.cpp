@@ -0,0 +1,49 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "board.h"
+#include "levels.h"
+#include "state_space.h"
+
+// Sweeps the whole reachable state space of the built-in levels and prints
+// difficulty metrics:
+//   ParkingJamMetrics [--threads N] [--max-states N] [level ...]
+int main(int argc, char** argv) {
+    StateSpaceOptions options;
+    std::vector<int> levels;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], NULL, 10);
+        } else {
+            levels.push_back(std::atoi(argv[i]));
+        }
+    }
+    if (levels.empty()) {
+        for (int level = 1; level <= BUILTIN_LEVEL_COUNT; level++) levels.push_back(level);
+    }
+
+    int failures = 0;
+    for (int levelNumber : levels) {
+        LevelSetup level;
+        if (!setupBuiltinLevel(levelNumber, level)) {
+            std::cerr << "Unknown level " << levelNumber << std::endl;
+            failures++;
+            continue;
+        }
+
+        Board board;
+        StateSpaceMetrics metrics;
+        if (!buildBoard(level, board) || !analyzeStateSpace(board, options, metrics)) {
+            failures++;
+            continue;
+        }
+
+        std::cout << "Level " << levelNumber << " (time budget " << level.gameTime << " s):" << std::endl;
+        printStateSpaceMetrics(std::cout, metrics);
+    }
+    return failures == 0 ? 0 : 1;
+}
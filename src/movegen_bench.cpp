@@ -0,0 +1,109 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "board.h"
+#include "levels.h"
+#include "process_stats.h"
+
+// Move generator microbenchmark: samples states along random walks through
+// each built-in level, checks the bitboard generator against the overlap
+// scan on all of them and reports moves generated per second for both.
+//   ParkingJamMoveBench [--states N] [--seconds S] [level ...]
+
+typedef void (*MoveGenerator)(const Board&, const BoardState&, std::vector<BoardMove>&);
+
+static double measure(MoveGenerator generate, const Board& board, const std::vector<BoardState>& states,
+                      double minSeconds, uint64_t& movesOut) {
+    std::vector<BoardMove> moves;
+    uint64_t total = 0;
+    double start = monotonicSeconds();
+    double elapsed = 0.0;
+    do {
+        for (const BoardState& state : states) {
+            generate(board, state, moves);
+            total += moves.size();
+        }
+        elapsed = monotonicSeconds() - start;
+    } while (elapsed < minSeconds);
+    movesOut = total;
+    return elapsed;
+}
+
+int main(int argc, char** argv) {
+    size_t sampleCount = 10000;
+    double minSeconds = 0.5;
+    std::vector<int> levels;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--states") == 0 && i + 1 < argc) {
+            sampleCount = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else {
+            levels.push_back(std::atoi(argv[i]));
+        }
+    }
+    if (levels.empty()) {
+        for (int level = 1; level <= BUILTIN_LEVEL_COUNT; level++) levels.push_back(level);
+    }
+
+    int failures = 0;
+    for (int levelNumber : levels) {
+        LevelSetup level;
+        Board board;
+        if (!setupBuiltinLevel(levelNumber, level) || !buildBoard(level, board)) {
+            std::cerr << "Cannot load level " << levelNumber << std::endl;
+            failures++;
+            continue;
+        }
+
+        // Fixed seed so runs are comparable
+        std::mt19937 rng(levelNumber);
+        std::vector<BoardState> states;
+        BoardState state = boardStartState(board);
+        std::vector<BoardMove> moves;
+        std::vector<BoardMove> reference;
+        bool mismatch = false;
+        while (states.size() < sampleCount) {
+            states.push_back(state);
+            generateBoardMoves(board, state, moves);
+            generateBoardMovesScan(board, state, reference);
+            if (moves.size() != reference.size() ||
+                !std::equal(moves.begin(), moves.end(), reference.begin(), [](const BoardMove& a, const BoardMove& b) {
+                    return a.car == b.car && a.delta == b.delta;
+                })) {
+                mismatch = true;
+                break;
+            }
+            if (moves.empty()) {
+                state = boardStartState(board);
+            } else {
+                applyBoardMove(state, moves[rng() % moves.size()]);
+            }
+        }
+        if (mismatch) {
+            std::cerr << "Level " << levelNumber << ": bitboard and scan generators disagree" << std::endl;
+            failures++;
+            continue;
+        }
+
+        std::cout << "Level " << levelNumber << " (" << board.cars.size() << " cars, " << states.size()
+                  << " states, " << board.laneWords * 64 << "-bit lanes):"
+                  << std::endl;
+        uint64_t scanMoves = 0;
+        uint64_t bitboardMoves = 0;
+        double scanSeconds = measure(generateBoardMovesScan, board, states, minSeconds, scanMoves);
+        double bitboardSeconds = measure(generateBoardMoves, board, states, minSeconds, bitboardMoves);
+        double scanRate = scanMoves / scanSeconds;
+        double bitboardRate = bitboardMoves / bitboardSeconds;
+        std::cout << std::fixed << std::setprecision(0)
+                  << "  scan      " << std::setw(14) << scanRate << " moves/s" << std::endl
+                  << "  bitboard  " << std::setw(14) << bitboardRate << " moves/s" << std::endl
+                  << std::setprecision(1) << "  speedup   " << std::setw(14) << bitboardRate / scanRate << "x"
+                  << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
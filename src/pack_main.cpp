@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "level_pack.h"
+#include "levels.h"
+#include "process_stats.h"
+
+// Builds and inspects binary level packs:
+//   ParkingJamPack OUT.pjlp [level.lvl ...]
+//     packs the level files in order, or the built-in levels if none are given
+//   ParkingJamPack --time PACK
+//     opens PACK and times loading every level the way the game does
+static int timePack(const std::string& path) {
+    double startTime = monotonicSeconds();
+    LevelPack pack;
+    if (!pack.open(path)) return 1;
+    double openSeconds = monotonicSeconds() - startTime;
+
+    LevelSetup level;
+    size_t carCount = 0;
+    double worstSeconds = 0.0;
+    startTime = monotonicSeconds();
+    for (int i = 0; i < pack.size(); i++) {
+        double levelStart = monotonicSeconds();
+        if (!pack.load(i, level)) return 1;
+        worstSeconds = std::max(worstSeconds, monotonicSeconds() - levelStart);
+        carCount += level.cars.size();
+    }
+    double loadSeconds = monotonicSeconds() - startTime;
+
+    std::cout << path << ": " << pack.size() << " levels, " << carCount << " cars" << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "  open " << openSeconds * 1e6 << " us" << std::endl;
+    if (pack.size() > 0) {
+        std::cout << "  load " << loadSeconds * 1e6 / pack.size() << " us per level (worst "
+                  << worstSeconds * 1e6 << " us)" << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::strcmp(argv[1], "--time") == 0) return timePack(argv[2]);
+    if (argc < 2 || argv[1][0] == '-') {
+        std::cerr << "Usage: ParkingJamPack OUT.pjlp [level.lvl ...] | ParkingJamPack --time PACK" << std::endl;
+        return 1;
+    }
+
+    LevelPackWriter writer;
+    if (!writer.open(argv[1])) return 1;
+
+    int failures = 0;
+    LevelSetup level;
+    if (argc == 2) {
+        for (int levelNumber = 1; levelNumber <= BUILTIN_LEVEL_COUNT; levelNumber++) {
+            setupBuiltinLevel(levelNumber, level);
+            if (!writer.add(level)) failures++;
+        }
+    }
+    for (int i = 2; i < argc; i++) {
+        if (!loadLevelFile(argv[i], level) || !writer.add(level)) failures++;
+    }
+    if (failures > 0 || !writer.finish()) return 1;
+
+    std::cout << "Wrote " << writer.size() << " levels to " << argv[1] << std::endl;
+    return 0;
+}
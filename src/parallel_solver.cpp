@@ -0,0 +1,312 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "process_stats.h"
+
+namespace {
+
+const int SHARD_BITS = 10;
+const int SHARD_COUNT = 1 << SHARD_BITS;
+const size_t CHUNK = 64;            // frontier states claimed per grab
+const uint32_t NO_PARENT = 0xFFFFFFFFu;
+const uint32_t FREE_SLOT = 0xFFFFFFFEu;  // parent of an empty visited slot
+
+// `parent` indexes the search's node list (every layer's frontier, in order),
+// so the entry does not carry a second packed key
+template <typename Key>
+struct VisitedEntry {
+    Key key;
+    uint64_t hash;
+    uint32_t parent;
+    BoardMove move;
+};
+
+// One lock per shard; the shard is picked from the top hash bits and the slot
+// from the low bits, so shards stay evenly loaded
+template <typename Key>
+class ShardedStateSet {
+public:
+    ShardedStateSet() : shards(SHARD_COUNT) {}
+
+    bool insert(const Key& key, uint64_t hash, uint32_t parent, BoardMove move) {
+        Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if ((shard.used + 1) * 2 > shard.slots.size()) shard.grow();
+        size_t i = hash & shard.mask;
+        while (shard.slots[i].parent != FREE_SLOT) {
+            if (shard.slots[i].hash == hash && shard.slots[i].key == key) return false;
+            i = (i + 1) & shard.mask;
+        }
+        shard.slots[i] = {key, hash, parent, move};
+        shard.used++;
+        return true;
+    }
+
+    // Only called once the workers are parked
+    const VisitedEntry<Key>* find(const Key& key, uint64_t hash) const {
+        const Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+        if (shard.slots.empty()) return NULL;
+        size_t i = hash & shard.mask;
+        while (shard.slots[i].parent != FREE_SLOT) {
+            if (shard.slots[i].hash == hash && shard.slots[i].key == key) return &shard.slots[i];
+            i = (i + 1) & shard.mask;
+        }
+        return NULL;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) total += shard.used;
+        return total;
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) total += shard.slots.size() * sizeof(VisitedEntry<Key>);
+        return total;
+    }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::vector<VisitedEntry<Key>> slots;
+        size_t mask = 0;
+        size_t used = 0;
+
+        void grow() {
+            std::vector<VisitedEntry<Key>> old;
+            old.swap(slots);
+            size_t capacity = old.empty() ? 256 : old.size() * 2;
+            slots.assign(capacity, VisitedEntry<Key>{Key(), 0, FREE_SLOT, {0, 0}});
+            mask = capacity - 1;
+            for (const VisitedEntry<Key>& e : old) {
+                if (e.parent == FREE_SLOT) continue;
+                size_t i = e.hash & mask;
+                while (slots[i].parent != FREE_SLOT) i = (i + 1) & mask;
+                slots[i] = e;
+            }
+        }
+    };
+
+    std::vector<Shard> shards;
+};
+
+// A worker's slice of the frontier. Owner and thieves both claim chunks with
+// fetch_add on `next`, so an idle worker can steal from a busy one.
+struct WorkRange {
+    std::atomic<size_t> next;
+    size_t end;
+};
+
+// Reusable barrier for the worker pool (std::barrier is C++20)
+class LayerBarrier {
+public:
+    explicit LayerBarrier(int count) : count(count), waiting(0), generation(0) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t arrived = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [&] { return generation != arrived; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    int count;
+    int waiting;
+    uint64_t generation;
+};
+
+// The workers live for the whole search: each layer the calling thread deals
+// out the ranges, everyone meets at the barrier, expands, meets again, and the
+// calling thread appends the new layer to `nodes`
+template <typename Key, int LANE_WORDS>
+struct ParallelBfsSearch {
+    const Board& board;
+    const SolveOptions& options;
+    SolveResult& result;
+
+    ParallelBfsSearch(const Board& b, const SolveOptions& o, SolveResult& r) : board(b), options(o), result(r) {}
+
+    // Leaves the moves labelled like `start` and the table size in stats.tableBytes
+    bool run(const BoardState& start) {
+        typedef BoardKeyCodec<Key> Codec;
+        ZobristTable zobrist;
+        buildZobristTable(board, zobrist);
+
+        int threadCount = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+        if (threadCount < 1) threadCount = 1;
+
+        // nodes[i] is the key of node i; a layer is a contiguous range of nodes
+        std::vector<Key> nodes(1, Codec::encode(packBoardState(board, start)));
+        ShardedStateSet<Key> visited;
+        visited.insert(nodes[0], zobristHash(zobrist, start), NO_PARENT, {0, 0});
+
+        std::atomic<bool> found(false);
+        std::atomic<bool> aborted(false);
+        std::atomic<uint64_t> expanded(0);
+        std::atomic<uint64_t> stored(1);
+        Key goalKey = nodes[0];
+        uint64_t goalHash = 0;
+        std::mutex goalMutex;
+
+        std::vector<std::vector<Key>> nextLayers(threadCount);
+        std::vector<WorkRange> ranges(threadCount);
+        LayerBarrier barrier(threadCount);
+        bool finished = false;      // written by the calling thread between layers
+
+        auto expandLayer = [&](int self) {
+            BoardState state;
+            std::vector<BoardMove> moves;
+            std::vector<Key>& out = nextLayers[self];
+            uint64_t localExpanded = 0;
+
+            for (int victim = 0; victim < threadCount && !found && !aborted; victim++) {
+                WorkRange& range = ranges[(self + victim) % threadCount];
+                while (!found && !aborted) {
+                    size_t begin = range.next.fetch_add(CHUNK);
+                    if (begin >= range.end) break;
+                    size_t end = std::min(begin + CHUNK, range.end);
+                    uint64_t inserted = 0;
+
+                    for (size_t i = begin; i < end && !found; i++) {
+                        BoardKey parent = Codec::decode(nodes[i]);
+                        unpackBoardState(board, parent, state);
+                        uint64_t parentHash = zobristHash(zobrist, state);
+                        generateBoardMovesFor<LANE_WORDS>(board, state, moves);
+                        localExpanded++;
+
+                        for (const BoardMove& move : moves) {
+                            int from = state[move.car];
+                            int to = from + move.delta;
+                            BoardKey child = parent;
+                            updateBoardKey(board, child, move.car, from, to);
+                            Key key = Codec::encode(child);
+                            uint64_t hash = zobristMove(zobrist, parentHash, move.car, from, to);
+                            applyBoardMove(state, move);
+                            if (visited.insert(key, hash, (uint32_t)i, move)) {
+                                out.push_back(key);
+                                inserted++;
+                                if (boardIsSolved(board, state)) {
+                                    std::lock_guard<std::mutex> lock(goalMutex);
+                                    if (!found) {
+                                        goalKey = key;
+                                        goalHash = hash;
+                                        found = true;
+                                    }
+                                }
+                            }
+                            state[move.car] = (uint8_t)(state[move.car] - move.delta);
+                        }
+                    }
+
+                    if (stored.fetch_add(inserted) + inserted >= options.maxStates ||
+                        (options.cancel && options.cancel->load(std::memory_order_relaxed))) {
+                        aborted = true;
+                    }
+                }
+            }
+            expanded += localExpanded;
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threadCount; t++) {
+            pool.emplace_back([&, t] {
+                for (;;) {
+                    barrier.wait();
+                    if (finished) return;
+                    expandLayer(t);
+                    barrier.wait();
+                }
+            });
+        }
+
+        size_t layerBegin = 0;
+        while (!found && !aborted && layerBegin < nodes.size()) {
+            size_t layerEnd = nodes.size();
+            size_t count = layerEnd - layerBegin;
+            size_t per = (count + threadCount - 1) / threadCount;
+            for (int t = 0; t < threadCount; t++) {
+                ranges[t].next = layerBegin + std::min(count, t * per);
+                ranges[t].end = layerBegin + std::min(count, (t + 1) * per);
+                nextLayers[t].clear();
+            }
+
+            barrier.wait();
+            expandLayer(0);
+            barrier.wait();
+
+            layerBegin = layerEnd;
+            for (const std::vector<Key>& part : nextLayers) {
+                nodes.insert(nodes.end(), part.begin(), part.end());
+            }
+        }
+
+        finished = true;
+        barrier.wait();
+        for (std::thread& thread : pool) thread.join();
+
+        result.stats.expanded = expanded;
+        result.stats.stored = visited.size();
+        result.stats.tableBytes = visited.bytes() + nodes.capacity() * sizeof(Key);
+        result.aborted = aborted && !found;
+
+        if (found) {
+            BoardState state;
+            Key key = goalKey;
+            uint64_t hash = goalHash;
+            for (;;) {
+                const VisitedEntry<Key>* entry = visited.find(key, hash);
+                if (entry->parent == NO_PARENT) break;
+                result.moves.push_back(entry->move);
+                key = nodes[entry->parent];
+                unpackBoardState(board, Codec::decode(key), state);
+                hash = zobristHash(zobrist, state);
+            }
+            std::reverse(result.moves.begin(), result.moves.end());
+            result.solved = true;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool solveParallelBfs(const Board& board, const BoardState& initial, const SolveOptions& options, SolveResult& result) {
+    result = SolveResult();
+    double startTime = monotonicSeconds();
+
+    // The visited set only ever sees canonical states (see canonicalizeBoardState)
+    BoardState start = initial;
+    std::vector<int> labels;
+    canonicalizeBoardState(board, start, &labels);
+
+    if (board.keyBits > BOARD_KEY_BITS) {
+        std::cerr << "Solver: board needs " << board.keyBits << " key bits (max " << BOARD_KEY_BITS << ")" << std::endl;
+        return false;
+    }
+    if (boardIsSolved(board, start)) {
+        result.solved = true;
+        result.stats.seconds = monotonicSeconds() - startTime;
+        result.stats.peakRssBytes = peakResidentBytes();
+        return true;
+    }
+
+    searchForBoardSize<ParallelBfsSearch>(board, start, options, result);
+    relabelBoardMoves(labels, result.moves);
+    result.stats.seconds = monotonicSeconds() - startTime;
+    result.stats.peakRssBytes = peakResidentBytes();
+    return true;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+// Peak resident set size of this process in bytes (0 if unavailable)
+size_t peakResidentBytes();
+
+// Wall-clock seconds from an arbitrary fixed point, for tool timings
+double monotonicSeconds();
@@ -0,0 +1,454 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "process_stats.h"
+
+namespace {
+
+const uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+// BFS nodes are appended in visit order, so the node array doubles as the
+// queue. Key is uint64_t on boards of at most 64 key bits (24-byte nodes
+// instead of 32), see BoardKeyCodec.
+template <typename Key>
+struct BfsNode {
+    Key key;
+    uint64_t hash;      // Zobrist hash, updated incrementally per move
+    uint32_t parent;
+    BoardMove move;
+};
+
+// Open-addressing set of node indices keyed by the node keys (4 bytes per slot)
+template <typename Key>
+class NodeIndex {
+public:
+    NodeIndex() : mask(0), used(0) { resize(1 << 16); }
+
+    // Returns true and records `node` if `key` was not present yet
+    bool insert(const Key& key, uint64_t hash, uint32_t node, const std::vector<BfsNode<Key>>& nodes) {
+        if ((used + 1) * 2 > slots.size()) grow(nodes);
+        size_t i = hash & mask;
+        while (slots[i] != EMPTY) {
+            if (nodes[slots[i]].hash == hash && nodes[slots[i]].key == key) return false;
+            i = (i + 1) & mask;
+        }
+        slots[i] = node;
+        used++;
+        return true;
+    }
+
+    size_t bytes() const { return slots.size() * sizeof(uint32_t); }
+
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    void resize(size_t capacity) {
+        slots.assign(capacity, EMPTY);
+        mask = capacity - 1;
+    }
+
+    void grow(const std::vector<BfsNode<Key>>& nodes) {
+        std::vector<uint32_t> old;
+        old.swap(slots);
+        resize(old.size() * 2);
+        for (uint32_t node : old) {
+            if (node == EMPTY) continue;
+            size_t i = nodes[node].hash & mask;
+            while (slots[i] != EMPTY) i = (i + 1) & mask;
+            slots[i] = node;
+        }
+    }
+
+    std::vector<uint32_t> slots;
+    size_t mask;
+    size_t used;
+};
+
+void finishStats(SolveStats& stats, double startTime, size_t tableBytes) {
+    stats.seconds = monotonicSeconds() - startTime;
+    stats.tableBytes = tableBytes;
+    stats.peakRssBytes = peakResidentBytes();
+}
+
+template <typename Key, int LANE_WORDS>
+struct BfsSearch {
+    const Board& board;
+    const SolveOptions& options;
+    SolveResult& result;
+
+    BfsSearch(const Board& b, const SolveOptions& o, SolveResult& r) : board(b), options(o), result(r) {}
+
+    // Leaves the moves labelled like `start` and the table size in stats.tableBytes
+    bool run(const BoardState& start) {
+        typedef BoardKeyCodec<Key> Codec;
+        ZobristTable zobrist;
+        buildZobristTable(board, zobrist);
+
+        std::vector<BfsNode<Key>> nodes;
+        NodeIndex<Key> index;
+        nodes.push_back({Codec::encode(packBoardState(board, start)), zobristHash(zobrist, start), NO_PARENT, {0, 0}});
+        index.insert(nodes[0].key, nodes[0].hash, 0, nodes);
+
+        BoardState state;
+        std::vector<BoardMove> moves;
+        uint32_t goal = NO_PARENT;
+
+        for (size_t head = 0; head < nodes.size() && goal == NO_PARENT; head++) {
+            BoardKey parent = Codec::decode(nodes[head].key);
+            unpackBoardState(board, parent, state);
+            generateBoardMovesFor<LANE_WORDS>(board, state, moves);
+            result.stats.expanded++;
+
+            for (const BoardMove& move : moves) {
+                int from = state[move.car];
+                int to = from + move.delta;
+                BoardKey child = parent;
+                updateBoardKey(board, child, move.car, from, to);
+                Key key = Codec::encode(child);
+                uint64_t hash = zobristMove(zobrist, nodes[head].hash, move.car, from, to);
+                applyBoardMove(state, move);
+                uint32_t node = (uint32_t)nodes.size();
+                if (index.insert(key, hash, node, nodes)) {
+                    nodes.push_back({key, hash, (uint32_t)head, move});
+                    if (boardIsSolved(board, state)) {
+                        goal = node;
+                        state[move.car] = (uint8_t)(state[move.car] - move.delta);
+                        break;
+                    }
+                }
+                state[move.car] = (uint8_t)(state[move.car] - move.delta);
+            }
+
+            if (nodes.size() >= options.maxStates ||
+                (options.cancel && options.cancel->load(std::memory_order_relaxed))) {
+                result.aborted = true;
+                break;
+            }
+        }
+
+        result.stats.stored = nodes.size();
+        result.stats.tableBytes = index.bytes() + nodes.capacity() * sizeof(BfsNode<Key>);
+
+        if (goal != NO_PARENT) {
+            for (uint32_t node = goal; nodes[node].parent != NO_PARENT; node = nodes[node].parent) {
+                result.moves.push_back(nodes[node].move);
+            }
+            std::reverse(result.moves.begin(), result.moves.end());
+            result.solved = true;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool solveBfs(const Board& board, const BoardState& initial, const SolveOptions& options, SolveResult& result) {
+    result = SolveResult();
+    double startTime = monotonicSeconds();
+
+    // The visited set only ever sees canonical states (see canonicalizeBoardState)
+    BoardState start = initial;
+    std::vector<int> labels;
+    canonicalizeBoardState(board, start, &labels);
+
+    if (board.keyBits > BOARD_KEY_BITS) {
+        std::cerr << "Solver: board needs " << board.keyBits << " key bits (max " << BOARD_KEY_BITS << ")" << std::endl;
+        return false;
+    }
+    if (boardIsSolved(board, start)) {
+        result.solved = true;
+        finishStats(result.stats, startTime, 0);
+        return true;
+    }
+
+    searchForBoardSize<BfsSearch>(board, start, options, result);
+    relabelBoardMoves(labels, result.moves);
+    finishStats(result.stats, startTime, result.stats.tableBytes);
+    return true;
+}
+
+// The heuristic reads overlaps off the board's lane masks: bit s of the mask
+// of link (car -> other) at other's slot is set when `car` in slot s overlaps
+// it. Cars that never meet have no link, and so no mask.
+static const uint64_t* linkMask(const Board& board, const BoardLaneLink& link, int otherSlot) {
+    return board.laneMasks.data() + link.offset + otherSlot * board.laneWords;
+}
+
+static const uint64_t* laneMaskAgainst(const Board& board, int car, int other, int otherSlot) {
+    for (int k = board.laneLinkStart[car]; k < board.laneLinkStart[car + 1]; k++) {
+        if (board.laneLinks[k].other == other) return linkMask(board, board.laneLinks[k], otherSlot);
+    }
+    return NULL;
+}
+
+static bool maskBit(const uint64_t* mask, int slot) {
+    return (mask[slot >> 6] >> (slot & 63)) & 1;
+}
+
+// Any of the slots lo..hi (inclusive) set
+static bool maskAny(const uint64_t* mask, int lo, int hi) {
+    for (int w = lo >> 6; w <= hi >> 6; w++) {
+        uint64_t bits = mask[w];
+        if (w == lo >> 6) bits &= ~0ULL << (lo & 63);
+        if (w == hi >> 6) bits &= ~0ULL >> (63 - (hi & 63));
+        if (bits) return true;
+    }
+    return false;
+}
+
+// Cars (other than `car` and the target) sitting on the slots `car` sweeps
+// through to reach `toSlot`
+static void markSweepBlockers(const Board& board, const BoardState& state, int car, int toSlot, uint8_t* marks) {
+    int lo = toSlot < state[car] ? toSlot : state[car] + 1;
+    int hi = toSlot < state[car] ? state[car] - 1 : toSlot;
+    for (int k = board.laneLinkStart[car]; k < board.laneLinkStart[car + 1]; k++) {
+        const BoardLaneLink& link = board.laneLinks[k];
+        if (link.other != board.target && maskAny(linkMask(board, link, state[link.other]), lo, hi)) {
+            marks[link.other] = 1;
+        }
+    }
+}
+
+int boardHeuristic(const Board& board, const BoardState& state) {
+    int t = board.target;
+    int ts = state[t];
+    if (ts >= board.exitSlot) return 0;
+
+    // Boards hold at most 255 cars, so the scratch lives on the stack
+    int n = (int)board.cars.size();
+    int firstHit[256];          // first target slot at which each car blocks
+    std::fill(firstHit, firstHit + n, -1);
+    int blockers = 0;
+    for (int k = board.laneLinkStart[t]; k < board.laneLinkStart[t + 1]; k++) {
+        const BoardLaneLink& link = board.laneLinks[k];
+        const uint64_t* mask = linkMask(board, link, state[link.other]);
+        for (int p = ts + 1; p <= board.exitSlot; p++) {
+            if (maskBit(mask, p)) {
+                firstHit[link.other] = p;
+                blockers++;
+                break;
+            }
+        }
+    }
+
+    uint8_t forced[256] = {0};
+    uint8_t side[256];
+    uint8_t common[256];
+    bool needsOutsider = false;
+
+    for (int b = 0; b < n; b++) {
+        if (firstHit[b] < 0) continue;
+        const BoardCar& car = board.cars[b];
+        // b's slots that still touch the target at its first blocked slot
+        const uint64_t* touching = laneMaskAgainst(board, b, t, firstHit[b]);
+
+        std::fill(common, common + n, 1);
+        bool feasible = false;
+        bool allNeedOutsider = true;
+
+        for (int dir = -1; dir <= 1; dir += 2) {
+            // Nearest slot on this side where b no longer touches the target
+            int clear = -1;
+            for (int slot = state[b] + dir; slot >= 0 && slot < car.slots; slot += dir) {
+                if (!maskBit(touching, slot)) {
+                    clear = slot;
+                    break;
+                }
+            }
+            if (clear < 0) continue;
+            feasible = true;
+
+            std::fill(side, side + n, 0);
+            markSweepBlockers(board, state, b, clear, side);
+
+            bool outsider = false;
+            for (int c = 0; c < n; c++) {
+                if (!side[c]) common[c] = 0;
+                if (side[c] && firstHit[c] < 0) outsider = true;
+            }
+            if (!outsider) allNeedOutsider = false;
+        }
+
+        if (!feasible) return BOARD_DEAD_END;
+        if (allNeedOutsider) needsOutsider = true;
+        for (int c = 0; c < n; c++) {
+            if (common[c] && firstHit[c] < 0) forced[c] = 1;
+        }
+    }
+
+    int second = 0;
+    for (int c = 0; c < n; c++) second += forced[c];
+    if (second == 0 && needsOutsider) second = 1;
+
+    return 1 + blockers + second;
+}
+
+namespace {
+
+template <typename Key, int LANE_WORDS>
+struct IdaSearch {
+    const Board& board;
+    const SolveOptions& options;
+    SolveResult& result;
+    SolveStats& stats;
+    ZobristTable zobrist;
+    uint64_t tableSalt;             // boardFingerprint: Zobrist seeds do not depend on the board
+    BoardState state;
+    std::vector<Key> pathKeys;
+    std::vector<BoardMove> path;
+    std::vector<std::vector<BoardMove>> movesAtDepth;
+    bool aborted;
+
+    IdaSearch(const Board& b, const SolveOptions& o, SolveResult& r)
+        : board(b), options(o), result(r), stats(r.stats), tableSalt(boardFingerprint(b)), aborted(false) {
+        buildZobristTable(board, zobrist);
+    }
+
+    Key packKey() const { return BoardKeyCodec<Key>::encode(packBoardState(board, state)); }
+
+    bool onPath(const Key& key) const {
+        for (const Key& k : pathKeys) {
+            if (k == key) return true;
+        }
+        return false;
+    }
+
+    // Table entries are per (board, state, car moved last): the search never
+    // moves the same car twice in a row, so a bound is only valid under the same
+    // restriction, and a table may be shared by searches over other boards
+    uint64_t tableKey(uint64_t hash, int lastCar) const {
+        return hash ^ tableSalt ^ (lastCar < 0 ? 0 : 0x9E3779B97F4A7C15ULL * (uint64_t)(lastCar + 1));
+    }
+
+    // Returns -1 when solved, otherwise the smallest f that exceeded `bound`.
+    // `cut` is set when a child was skipped for being on the current path; such
+    // a subtree bound is not a true lower bound and is not stored.
+    int search(int g, int bound, int lastCar, uint64_t hash, bool& cut) {
+        int h = boardHeuristic(board, state);
+        if (h >= BOARD_DEAD_END) return BOARD_DEAD_END;
+
+        uint64_t key = tableKey(hash, lastCar);
+        TTEntry entry;
+        if (options.table && options.table->probe(key, entry) && entry.distance > h) {
+            h = entry.distance;
+        }
+        if (g + h > bound) return g + h;
+        if (h == 0) return -1;
+
+        if (stats.expanded >= options.maxExpansions ||
+            (options.cancel && options.cancel->load(std::memory_order_relaxed))) {
+            aborted = true;
+            return BOARD_DEAD_END;
+        }
+        stats.expanded++;
+
+        // Deeper calls may grow movesAtDepth, so index it instead of holding a reference
+        if ((int)movesAtDepth.size() <= g) movesAtDepth.resize(g + 1);
+        generateBoardMovesFor<LANE_WORDS>(board, state, movesAtDepth[g]);
+
+        int next = BOARD_DEAD_END;
+        bool subtreeCut = false;
+        for (size_t i = 0; i < movesAtDepth[g].size(); i++) {
+            BoardMove move = movesAtDepth[g][i];
+            // Two slides of the same car in a row are never needed
+            if (move.car == lastCar) continue;
+
+            int from = state[move.car];
+            int to = from + move.delta;
+            applyBoardMove(state, move);
+            Key childKey = packKey();
+            if (!onPath(childKey)) {
+                pathKeys.push_back(childKey);
+                path.push_back(move);
+                int childBound = search(g + 1, bound, move.car, zobristMove(zobrist, hash, move.car, from, to),
+                                        subtreeCut);
+                if (childBound < 0) {
+                    if (options.table) {
+                        int distance = (int)path.size() - g;
+                        options.table->store(key, distance, distance, TT_EXACT);
+                    }
+                    return -1;
+                }
+                pathKeys.pop_back();
+                path.pop_back();
+                next = std::min(next, childBound);
+            } else {
+                subtreeCut = true;
+            }
+            state[move.car] = (uint8_t)from;
+            if (aborted) return BOARD_DEAD_END;
+        }
+
+        if (subtreeCut) {
+            cut = true;
+        } else if (options.table && next < BOARD_DEAD_END) {
+            options.table->store(key, next - g, next - g, TT_LOWER);
+        }
+        return next;
+    }
+
+    // Leaves the path size in stats.tableBytes
+    bool run(const BoardState& start) {
+        state = start;
+        pathKeys.push_back(packKey());
+        uint64_t startHash = zobristHash(zobrist, start);
+        if (options.table) options.table->newGeneration();
+
+        int bound = boardHeuristic(board, start);
+        while (bound < BOARD_DEAD_END) {
+            bool cut = false;
+            int next = search(0, bound, -1, startHash, cut);
+            if (next < 0) {
+                result.solved = true;
+                result.moves = path;
+                break;
+            }
+            bound = next;
+        }
+        result.aborted = aborted;
+
+        size_t pathBytes = pathKeys.capacity() * sizeof(Key) + path.capacity() * sizeof(BoardMove);
+        for (const auto& moves : movesAtDepth) pathBytes += moves.capacity() * sizeof(BoardMove);
+        if (options.table) pathBytes += options.table->bytes();
+        stats.stored = movesAtDepth.size();
+        stats.tableBytes = pathBytes;
+        return true;
+    }
+};
+
+} // namespace
+
+bool solveIdaStar(const Board& board, const BoardState& start, const SolveOptions& options, SolveResult& result) {
+    result = SolveResult();
+    double startTime = monotonicSeconds();
+
+    if (board.keyBits > BOARD_KEY_BITS) {
+        std::cerr << "Solver: board needs " << board.keyBits << " key bits (max " << BOARD_KEY_BITS << ")" << std::endl;
+        return false;
+    }
+
+    searchForBoardSize<IdaSearch>(board, start, options, result);
+    finishStats(result.stats, startTime, result.stats.tableBytes);
+    return true;
+}
+
+void printTableStats(std::ostream& out, const TranspositionTable& table) {
+    TTStats s = table.stats();
+    uint64_t probes = s.hits + s.misses;
+    out << std::fixed << std::setprecision(1)
+        << "  table " << table.bytes() / (1024.0 * 1024.0) << " MB (" << table.capacity() << " entries): "
+        << s.hits << " hits, " << s.misses << " misses, " << s.collisions << " collisions, "
+        << s.evictions << " evictions, hit rate " << (probes ? 100.0 * s.hits / probes : 0.0) << "%" << std::endl;
+}
+
+void printSolveStats(std::ostream& out, const SolveStats& stats) {
+    out << std::fixed << std::setprecision(2)
+        << "  states explored " << stats.expanded << " (stored " << stats.stored << ") in "
+        << stats.seconds * 1000.0 << " ms, " << std::setprecision(0) << stats.statesPerSecond() << " states/s"
+        << std::endl << std::setprecision(2)
+        << "  table " << stats.tableBytes / (1024.0 * 1024.0) << " MB, peak RSS "
+        << stats.peakRssBytes / (1024.0 * 1024.0) << " MB" << std::endl;
+}
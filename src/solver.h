@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "board.h"
+#include "transposition_table.h"
+
+struct SolveOptions {
+    uint64_t maxStates = 50000000;   // BFS: give up once this many states are stored
+    uint64_t maxExpansions = 2000000000ULL;  // IDA*: give up after this many expansions
+    int threads = 0;                 // parallel BFS workers, 0 = one per hardware thread
+    TranspositionTable* table = NULL;  // IDA*: optional shared cache of distance bounds
+    const std::atomic<bool>* cancel = NULL;  // set from another thread to stop early (aborted)
+    const char* scratchDirectory = ".";  // external BFS: where layer and run files go
+    size_t memoryBytes = 1ULL << 30;     // external BFS: child buffer sorted in memory before spilling
+};
+
+struct SolveStats {
+    uint64_t expanded = 0;           // states whose moves were generated
+    uint64_t stored = 0;             // distinct states kept in the visited set
+    double seconds = 0.0;
+    size_t tableBytes = 0;           // visited set + node storage at the end of the search
+    size_t peakRssBytes = 0;
+
+    double statesPerSecond() const { return seconds > 0.0 ? expanded / seconds : 0.0; }
+};
+
+struct SolveResult {
+    bool solved = false;
+    bool aborted = false;            // hit maxStates / maxExpansions, or cancelled
+    std::vector<BoardMove> moves;    // optimal sequence, one slide per move
+    SolveStats stats;
+};
+
+// Breadth-first search over packed states; `moves` is optimal in slides
+bool solveBfs(const Board& board, const BoardState& start, const SolveOptions& options, SolveResult& result);
+
+// Level-synchronous BFS: workers expand chunks of the current layer (stealing
+// from each other when their own slice runs dry) and deduplicate into a
+// sharded, per-shard-locked visited set
+bool solveParallelBfs(const Board& board, const BoardState& start, const SolveOptions& options, SolveResult& result);
+
+// BFS with the layers on disk: each layer is a sorted file of packed keys.
+// Children of a layer are buffered, sorted and spilled in runs, and the runs
+// are merged into the next layer while duplicates against the two previous
+// layers are dropped (slides are reversible, so no older layer can hold a
+// child). Memory stays at about memoryBytes whatever the state count; the
+// solution is recovered afterwards by scanning the layer files backwards.
+bool solveExternalBfs(const Board& board, const BoardState& start, const SolveOptions& options, SolveResult& result);
+
+// Iterative-deepening A* with boardHeuristic: optimal like solveBfs, but only
+// keeps the current path in memory
+bool solveIdaStar(const Board& board, const BoardState& start, const SolveOptions& options, SolveResult& result);
+
+const int BOARD_DEAD_END = 1 << 20;
+
+// Admissible lower bound on the slides left:
+//   1 for the target car if it has not reached the exit yet
+// + 1 per car blocking the target's row between it and the exit
+// + cars that must move before some blocker can clear the row (recursive blockers)
+// Returns BOARD_DEAD_END if a blocker can never leave the row.
+int boardHeuristic(const Board& board, const BoardState& state);
+
+void printSolveStats(std::ostream& out, const SolveStats& stats);
+void printTableStats(std::ostream& out, const TranspositionTable& table);
+
+// Runs Search<Key, LANE_WORDS>(board, options, result).run(start) with the
+// packed key type and the lane bitboard width (generateBoardMovesFor) the
+// board needs, both fixed at compile time. Callers check keyBits first.
+template <template <typename, int> class Search, typename Key>
+bool searchWithLanes(const Board& board, const BoardState& start, const SolveOptions& options,
+                     SolveResult& result) {
+    if (board.laneWords == 1) return Search<Key, 1>(board, options, result).run(start);
+    if (board.laneWords == 2) return Search<Key, 2>(board, options, result).run(start);
+    return Search<Key, BOARD_LANE_WORDS>(board, options, result).run(start);
+}
+
+template <template <typename, int> class Search>
+bool searchForBoardSize(const Board& board, const BoardState& start, const SolveOptions& options,
+                        SolveResult& result) {
+    if (board.keyBits <= 64) return searchWithLanes<Search, uint64_t>(board, start, options, result);
+    return searchWithLanes<Search, BoardKey>(board, start, options, result);
+}
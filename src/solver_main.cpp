@@ -0,0 +1,202 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "board.h"
+#include "distance_db.h"
+#include "incremental_solver.h"
+#include "levels.h"
+#include "solver.h"
+
+// Headless solver for the built-in levels:
+//   ParkingJamSolver [--ida [--table-mb N] | --parallel [--threads N] |
+//                     --external [--scratch DIR] [--memory-mb N]]
+//                    [--max-states N] [--max-expansions N] [level ...]
+//   ParkingJamSolver --incremental [--steps N] [level ...]
+//     plays N moves (alternately a random slide and the hinted one), re-solving
+//     after each with IncrementalSolver and reporting the work it reused
+//   ParkingJamSolver --write-db DIR [--max-states N] [level ...]
+//     writes DIR/level<N>.pjdb, the distance table the game maps for hints
+static bool writeDistanceDatabase(const Board& board, int levelNumber, const std::string& directory,
+                                  uint64_t maxStates) {
+    std::string path = distanceDatabasePath(directory, levelNumber);
+    DistanceDbBuildStats stats;
+    if (!buildDistanceDatabase(board, path, maxStates, stats)) return false;
+
+    // Read it back the way the game will and check the start state
+    DistanceDatabase database;
+    int distance;
+    if (!database.open(path, board) || !database.lookup(packBoardState(board, boardStartState(board)), distance) ||
+        distance != stats.startDistance) {
+        std::cerr << "Verification of " << path << " failed" << std::endl;
+        return false;
+    }
+
+    std::cout << "Level " << levelNumber << ": wrote " << path << std::endl;
+    std::cout << "  states " << stats.states << ", solvable " << stats.solvable
+              << ", max distance " << stats.maxDistance << ", start distance ";
+    if (stats.startDistance == DISTANCE_DB_UNSOLVABLE) {
+        std::cout << "UNSOLVABLE";
+    } else {
+        std::cout << stats.startDistance;
+    }
+    std::cout << std::endl;
+    std::cout << "  " << stats.fileBytes << " bytes in " << stats.seconds << " s" << std::endl;
+    return true;
+}
+
+static void replayIncremental(const Board& board, int levelNumber, const SolveOptions& options, int steps) {
+    IncrementalSolver solver;
+    solver.reset(board);
+    std::mt19937 rng(levelNumber);
+    BoardState state = boardStartState(board);
+    std::vector<BoardMove> moves;
+
+    std::cout << "Level " << levelNumber << ": incremental re-solve over " << steps << " player moves" << std::endl;
+    for (int step = 0; step <= steps && !boardIsSolved(board, state); step++) {
+        SolveResult result;
+        ResolveStats reuse;
+        if (!solver.solve(state, options, result, reuse) || !result.solved) {
+            std::cout << "  step " << step << ": no solution" << std::endl;
+            return;
+        }
+        std::cout << "  step " << step << ": " << result.moves.size() << " moves left, ";
+        if (reuse.fromKnown) {
+            std::cout << "from known distances" << std::endl;
+        } else {
+            std::cout << reuse.expanded << " expanded, " << reuse.tableHits << " table hits, "
+                      << std::fixed << std::setprecision(1) << reuse.savedFraction() * 100.0
+                      << "% saved vs the first search" << std::endl;
+        }
+
+        // Odd steps follow the hint, even steps wander off the optimal line
+        generateBoardMoves(board, state, moves);
+        const BoardMove& move = step % 2 ? result.moves[0] : moves[rng() % moves.size()];
+        applyBoardMove(state, move);
+    }
+}
+
+int main(int argc, char** argv) {
+    SolveOptions options;
+    bool useIda = false;
+    bool useParallel = false;
+    bool useExternal = false;
+    bool maxStatesGiven = false;
+    size_t tableMegabytes = 0;
+    const char* databaseDirectory = NULL;
+    bool incremental = false;
+    int incrementalSteps = 10;
+    std::vector<int> levels;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], NULL, 10);
+            maxStatesGiven = true;
+        } else if (std::strcmp(argv[i], "--max-expansions") == 0 && i + 1 < argc) {
+            options.maxExpansions = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--table-mb") == 0 && i + 1 < argc) {
+            tableMegabytes = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--write-db") == 0 && i + 1 < argc) {
+            databaseDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--incremental") == 0) {
+            incremental = true;
+        } else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            incrementalSteps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scratch") == 0 && i + 1 < argc) {
+            options.scratchDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+            options.memoryBytes = (size_t)std::strtoull(argv[++i], NULL, 10) << 20;
+        } else if (std::strcmp(argv[i], "--external") == 0) {
+            useExternal = true;
+        } else if (std::strcmp(argv[i], "--ida") == 0) {
+            useIda = true;
+        } else if (std::strcmp(argv[i], "--parallel") == 0) {
+            useParallel = true;
+        } else {
+            char* end = NULL;
+            long level = std::strtol(argv[i], &end, 10);
+            if (argv[i][0] == '-' || end == argv[i] || *end != '\0') {
+                std::cerr << "Bad argument " << argv[i] << std::endl;
+                std::cerr << "Usage: ParkingJamSolver [--ida [--table-mb N] | --parallel [--threads N] | --external "
+                             "[--scratch DIR] [--memory-mb N] | --incremental [--steps N] | --write-db DIR] "
+                             "[--max-states N] [--max-expansions N] [level ...]" << std::endl;
+                return 1;
+            }
+            levels.push_back((int)level);
+        }
+    }
+    // The disk-backed search exists for state spaces past the in-memory cap
+    if (useExternal && !maxStatesGiven) options.maxStates = UINT64_MAX;
+    if (levels.empty()) {
+        for (int level = 1; level <= BUILTIN_LEVEL_COUNT; level++) levels.push_back(level);
+    }
+
+    std::unique_ptr<TranspositionTable> table;
+    if (useIda && tableMegabytes > 0) {
+        table.reset(new TranspositionTable(tableMegabytes));
+        options.table = table.get();
+    }
+
+    int failures = 0;
+    for (int levelNumber : levels) {
+        LevelSetup level;
+        if (!setupBuiltinLevel(levelNumber, level)) {
+            std::cerr << "Unknown level " << levelNumber << std::endl;
+            failures++;
+            continue;
+        }
+
+        Board board;
+        SolveResult result;
+        if (!buildBoard(level, board)) {
+            failures++;
+            continue;
+        }
+        if (incremental) {
+            replayIncremental(board, levelNumber, options, incrementalSteps);
+            continue;
+        }
+        if (databaseDirectory) {
+            if (!writeDistanceDatabase(board, levelNumber, databaseDirectory, options.maxStates)) failures++;
+            continue;
+        }
+
+        bool ok;
+        if (useIda) {
+            ok = solveIdaStar(board, boardStartState(board), options, result);
+        } else if (useExternal) {
+            ok = solveExternalBfs(board, boardStartState(board), options, result);
+        } else if (useParallel) {
+            ok = solveParallelBfs(board, boardStartState(board), options, result);
+        } else {
+            ok = solveBfs(board, boardStartState(board), options, result);
+        }
+        if (!ok) {
+            failures++;
+            continue;
+        }
+
+        std::cout << "Level " << levelNumber << ": ";
+        if (result.solved) {
+            std::cout << "solved in " << result.moves.size() << " moves" << std::endl;
+        } else if (result.aborted) {
+            std::cout << "gave up after " << result.stats.expanded << " expansions" << std::endl;
+        } else {
+            std::cout << "UNSOLVABLE" << std::endl;
+        }
+        printSolveStats(std::cout, result.stats);
+        if (table) {
+            printTableStats(std::cout, *table);
+            table->clear();     // stats per level; other boards' bounds are no use here
+        }
+        for (size_t i = 0; i < result.moves.size(); i++) {
+            std::cout << "  " << (i + 1) << ". " << describeBoardMove(board, result.moves[i]) << std::endl;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+#include "state_space.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "process_stats.h"
+
+namespace {
+
+const size_t CHUNK = 256;           // layer entries claimed per grab
+
+typedef std::vector<uint64_t> KeyRun;
+
+template <typename Work>
+void runWorkers(int threadCount, Work work) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++) threads.emplace_back(work, t);
+    work(0);
+    for (auto& thread : threads) thread.join();
+}
+
+void sortUnique(KeyRun& run) {
+    std::sort(run.begin(), run.end());
+    run.erase(std::unique(run.begin(), run.end()), run.end());
+}
+
+// Union of sorted, duplicate-free runs, merged pairwise with one pair per thread
+void mergeRuns(std::vector<KeyRun>& runs, int threadCount, KeyRun& out) {
+    while (runs.size() > 1) {
+        size_t pairs = runs.size() / 2;
+        std::vector<KeyRun> merged(pairs + runs.size() % 2);
+        if (runs.size() % 2) merged.back().swap(runs.back());
+
+        std::atomic<size_t> next(0);
+        runWorkers((int)std::min((size_t)threadCount, pairs), [&](int) {
+            size_t pair;
+            while ((pair = next.fetch_add(1)) < pairs) {
+                KeyRun& a = runs[pair * 2];
+                KeyRun& b = runs[pair * 2 + 1];
+                KeyRun& result = merged[pair];
+                result.resize(a.size() + b.size());
+                result.erase(std::set_union(a.begin(), a.end(), b.begin(), b.end(), result.begin()), result.end());
+                KeyRun().swap(a);
+                KeyRun().swap(b);
+            }
+        });
+        runs.swap(merged);
+    }
+    out.clear();
+    if (!runs.empty()) out.swap(runs[0]);
+    runs.clear();
+}
+
+void subtract(KeyRun& keys, const KeyRun& remove) {
+    if (remove.empty()) return;
+    KeyRun kept(keys.size());
+    kept.erase(std::set_difference(keys.begin(), keys.end(), remove.begin(), remove.end(), kept.begin()), kept.end());
+    keys.swap(kept);
+}
+
+} // namespace
+
+bool analyzeStateSpace(const Board& board, const StateSpaceOptions& options, StateSpaceMetrics& metrics) {
+    metrics = StateSpaceMetrics();
+    double startTime = monotonicSeconds();
+
+    if (board.keyBits > 64) {
+        std::cerr << "State space: board needs " << board.keyBits << " key bits (the sweep packs states into 64)"
+                  << std::endl;
+        return false;
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+
+    uint64_t startKey = packBoardState(board, boardStartState(board)).lo;
+
+    // Forward sweep. Winning states end the level, so they are recorded but
+    // not expanded; that breaks the "neighbours lie within one layer" rule for
+    // them, hence the extra `goals` filter.
+    std::vector<KeyRun> layers(1, KeyRun(1, startKey));
+    KeyRun goals;
+    std::atomic<uint64_t> edges(0);
+
+    while (!layers.back().empty()) {
+        const KeyRun& current = layers.back();
+        metrics.layerSizes.push_back(current.size());
+        metrics.states += current.size();
+        if (metrics.states > options.maxStates) {
+            std::cerr << "State space: more than " << options.maxStates << " reachable states" << std::endl;
+            return false;
+        }
+
+        std::vector<KeyRun> found(threadCount);
+        std::vector<KeyRun> foundGoals(threadCount);
+        std::atomic<size_t> next(0);
+        runWorkers(threadCount, [&](int self) {
+            BoardState state;
+            std::vector<BoardMove> moves;
+            KeyRun& out = found[self];
+            uint64_t localEdges = 0;
+
+            while (true) {
+                size_t begin = next.fetch_add(CHUNK);
+                if (begin >= current.size()) break;
+                size_t end = std::min(begin + CHUNK, current.size());
+
+                for (size_t i = begin; i < end; i++) {
+                    BoardKey key = {current[i], 0};
+                    unpackBoardState(board, key, state);
+                    if (boardIsSolved(board, state)) {
+                        foundGoals[self].push_back(key.lo);
+                        continue;
+                    }
+                    generateBoardMoves(board, state, moves);
+                    localEdges += moves.size();
+                    for (const BoardMove& move : moves) {
+                        BoardKey child = key;
+                        updateBoardKey(board, child, move.car, state[move.car], state[move.car] + move.delta);
+                        out.push_back(child.lo);
+                    }
+                }
+            }
+            sortUnique(out);
+            edges += localEdges;
+        });
+
+        for (const KeyRun& part : foundGoals) goals.insert(goals.end(), part.begin(), part.end());
+        std::sort(goals.begin(), goals.end());
+
+        KeyRun layer;
+        mergeRuns(found, threadCount, layer);
+        subtract(layer, current);
+        if (layers.size() > 1) subtract(layer, layers[layers.size() - 2]);
+        subtract(layer, goals);
+        layers.push_back(KeyRun());
+        layers.back().swap(layer);
+    }
+    layers.pop_back();
+    metrics.startEccentricity = (int)layers.size() - 1;
+    metrics.goalStates = goals.size();
+    metrics.edges = edges;
+
+    // Every reachable key, sorted; a state's index in here is its visited bit
+    KeyRun reachable;
+    mergeRuns(layers, threadCount, reachable);
+    uint64_t stateCount = reachable.size();
+
+    size_t words = (size_t)((stateCount + 63) / 64);
+    std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[words]);
+    for (size_t i = 0; i < words; i++) visited[i].store(0, std::memory_order_relaxed);
+
+    auto indexOf = [&reachable](uint64_t key) -> int64_t {
+        auto it = std::lower_bound(reachable.begin(), reachable.end(), key);
+        if (it == reachable.end() || *it != key) return -1;
+        return it - reachable.begin();
+    };
+    auto claim = [&visited](uint64_t index) {
+        uint64_t bit = 1ULL << (index & 63);
+        return (visited[index >> 6].fetch_or(bit) & bit) == 0;
+    };
+    auto isVisited = [&visited](uint64_t index) {
+        return (visited[index >> 6].load() >> (index & 63)) & 1;
+    };
+
+    // Retrograde sweep: layer d holds the states exactly d slides from a win.
+    // Slides are reversible, so a state's predecessors are its own successors.
+    KeyRun frontier;
+    for (uint64_t goal : goals) {
+        uint64_t index = (uint64_t)indexOf(goal);
+        claim(index);
+        frontier.push_back(index);
+    }
+    uint64_t startIndex = (uint64_t)indexOf(startKey);
+    uint64_t solvable = 0;
+
+    while (!frontier.empty()) {
+        if (metrics.solutionLength < 0 && isVisited(startIndex)) {
+            metrics.solutionLength = (int)metrics.distanceHistogram.size();
+        }
+        metrics.distanceHistogram.push_back(frontier.size());
+        solvable += frontier.size();
+
+        std::vector<KeyRun> found(threadCount);
+        std::atomic<size_t> next(0);
+        runWorkers(threadCount, [&](int self) {
+            BoardState state;
+            std::vector<BoardMove> moves;
+            KeyRun& out = found[self];
+
+            while (true) {
+                size_t begin = next.fetch_add(CHUNK);
+                if (begin >= frontier.size()) break;
+                size_t end = std::min(begin + CHUNK, frontier.size());
+
+                for (size_t i = begin; i < end; i++) {
+                    BoardKey key = {reachable[frontier[i]], 0};
+                    unpackBoardState(board, key, state);
+                    generateBoardMoves(board, state, moves);
+                    for (const BoardMove& move : moves) {
+                        BoardKey child = key;
+                        updateBoardKey(board, child, move.car, state[move.car], state[move.car] + move.delta);
+                        int64_t index = indexOf(child.lo);
+                        if (index >= 0 && claim((uint64_t)index)) out.push_back((uint64_t)index);
+                    }
+                }
+            }
+        });
+
+        frontier.clear();
+        for (const KeyRun& part : found) frontier.insert(frontier.end(), part.begin(), part.end());
+    }
+
+    if (!metrics.distanceHistogram.empty()) {
+        metrics.maxDistance = (int)metrics.distanceHistogram.size() - 1;
+        metrics.statesAtMaxDistance = metrics.distanceHistogram.back();
+    }
+    metrics.deadStates = stateCount - solvable;
+    metrics.seconds = monotonicSeconds() - startTime;
+    metrics.peakRssBytes = peakResidentBytes();
+    return true;
+}
+
+void printStateSpaceMetrics(std::ostream& out, const StateSpaceMetrics& metrics) {
+    out << "  states " << metrics.states << " (" << metrics.goalStates << " winning, "
+        << metrics.deadStates << " dead)" << std::endl;
+    out << "  optimal solution ";
+    if (metrics.solutionLength < 0) {
+        out << "UNSOLVABLE" << std::endl;
+    } else {
+        out << metrics.solutionLength << " slides" << std::endl;
+    }
+    out << "  hardest state " << metrics.maxDistance << " slides from a win ("
+        << metrics.statesAtMaxDistance << " states)" << std::endl;
+    // The exact diameter needs a BFS from every state; any shortest distance is a
+    // lower bound and twice the start's eccentricity an upper one
+    out << "  diameter between " << std::max(metrics.startEccentricity, metrics.maxDistance) << " and "
+        << 2 * metrics.startEccentricity << " (start eccentricity " << metrics.startEccentricity << ")" << std::endl;
+    out << std::fixed << std::setprecision(2)
+        << "  branching factor " << metrics.branchingFactor() << " (" << metrics.edges << " moves)" << std::endl;
+    out << "  distance to win:";
+    for (size_t d = 0; d < metrics.distanceHistogram.size(); d++) {
+        out << " " << d << ":" << metrics.distanceHistogram[d];
+    }
+    out << std::endl;
+    out << "  " << metrics.seconds * 1000.0 << " ms, peak RSS "
+        << metrics.peakRssBytes / (1024.0 * 1024.0) << " MB" << std::endl;
+}
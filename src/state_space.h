@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "board.h"
+
+struct StateSpaceOptions {
+    int threads = 0;                 // workers, 0 = one per hardware thread
+    uint64_t maxStates = 1000000000ULL;  // give up once this many states are reachable
+};
+
+struct StateSpaceMetrics {
+    uint64_t states = 0;             // reachable from the start; winning states are not expanded
+    uint64_t goalStates = 0;
+    uint64_t deadStates = 0;         // reachable, but no win can be reached from them
+    uint64_t edges = 0;              // legal slides summed over the expanded states
+    int solutionLength = -1;         // optimal slides from the start, -1 if unsolvable
+    int startEccentricity = 0;       // depth of the forward sweep
+    int maxDistance = 0;             // largest finite distance to a win
+    uint64_t statesAtMaxDistance = 0;
+    std::vector<uint64_t> layerSizes;         // states per distance from the start
+    std::vector<uint64_t> distanceHistogram;  // states per distance to the nearest win
+    double seconds = 0.0;
+    size_t peakRssBytes = 0;
+
+    double branchingFactor() const {
+        uint64_t expanded = states - goalStates;
+        return expanded ? (double)edges / expanded : 0.0;
+    }
+};
+
+// Two sweeps over the whole reachable state space:
+//   forward      level-synchronous BFS from the start. States are 64-bit
+//                packed keys kept in sorted arrays; since slides are
+//                reversible, a new layer only has to be deduplicated against
+//                the previous two layers (and the winning states found so far).
+//   retrograde   BFS from every winning state at once over the sorted array
+//                of reachable keys, with one visited bit per state.
+// Both sweeps split each layer across threads. Needs board.keyBits <= 64.
+bool analyzeStateSpace(const Board& board, const StateSpaceOptions& options, StateSpaceMetrics& metrics);
+
+void printStateSpaceMetrics(std::ostream& out, const StateSpaceMetrics& metrics);
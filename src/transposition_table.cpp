@@ -0,0 +1,109 @@
+#include "transposition_table.h"
+
+// data layout: distance:16 | depth:16 | bound:2 | generation:8
+static uint64_t packEntry(int distance, int depth, TTBound bound, uint32_t generation) {
+    return (uint64_t)(distance & 0xFFFF) |
+           ((uint64_t)(depth & 0xFFFF) << 16) |
+           ((uint64_t)bound << 32) |
+           ((uint64_t)(generation & 0xFF) << 34);
+}
+
+static int entryDistance(uint64_t data) { return (int)(data & 0xFFFF); }
+static int entryDepth(uint64_t data) { return (int)((data >> 16) & 0xFFFF); }
+static TTBound entryBound(uint64_t data) { return (TTBound)((data >> 32) & 3); }
+static uint32_t entryGeneration(uint64_t data) { return (uint32_t)((data >> 34) & 0xFF); }
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : bucketCount(1), generation(0), hits(0), misses(0), collisions(0), stores(0), evictions(0) {
+    size_t budget = megabytes * 1024 * 1024;
+    while (bucketCount * 2 * sizeof(Bucket) <= budget) bucketCount *= 2;
+    buckets.reset(new Bucket[bucketCount]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t b = 0; b < bucketCount; b++) {
+        for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+            buckets[b].check[i].store(0, std::memory_order_relaxed);
+            buckets[b].data[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    hits = misses = collisions = stores = evictions = 0;
+}
+
+bool TranspositionTable::probe(uint64_t hash, TTEntry& entry) {
+    Bucket& bucket = buckets[hash & (bucketCount - 1)];
+    bool full = true;
+    for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+        uint64_t data = bucket.data[i].load(std::memory_order_relaxed);
+        uint64_t check = bucket.check[i].load(std::memory_order_relaxed);
+        if (data == 0) {
+            full = false;
+            continue;
+        }
+        if ((check ^ data) == hash) {
+            entry.distance = entryDistance(data);
+            entry.depth = entryDepth(data);
+            entry.bound = entryBound(data);
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    if (full) collisions.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void TranspositionTable::store(uint64_t hash, int distance, int depth, TTBound bound) {
+    Bucket& bucket = buckets[hash & (bucketCount - 1)];
+    uint32_t now = generation.load(std::memory_order_relaxed);
+    uint64_t data = packEntry(distance, depth, bound, now);
+
+    // Same state: keep whichever entry carries more information.
+    // Otherwise replace the empty, then stale, then shallowest entry.
+    int victim = 0;
+    int victimScore = 1 << 30;
+    for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+        uint64_t old = bucket.data[i].load(std::memory_order_relaxed);
+        uint64_t check = bucket.check[i].load(std::memory_order_relaxed);
+        if (old != 0 && (check ^ old) == hash) {
+            bool keepOld = entryBound(old) == TT_EXACT ||
+                           (bound != TT_EXACT && entryDistance(old) >= distance && entryDepth(old) >= depth);
+            if (keepOld) return;
+            victim = i;
+            victimScore = -1;
+            break;
+        }
+        int score;
+        if (old == 0) {
+            score = -1;
+        } else {
+            bool stale = entryGeneration(old) != (now & 0xFF);
+            score = (stale ? 0 : 0x10000) + entryDepth(old) + (entryBound(old) == TT_EXACT ? 0x20000 : 0);
+        }
+        if (score < victimScore) {
+            victim = i;
+            victimScore = score;
+            if (score < 0) break;
+        }
+    }
+
+    uint64_t previous = bucket.data[victim].load(std::memory_order_relaxed);
+    uint64_t previousCheck = bucket.check[victim].load(std::memory_order_relaxed);
+    if (previous != 0 && (previousCheck ^ previous) != hash) {
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    bucket.check[victim].store(hash ^ data, std::memory_order_relaxed);
+    bucket.data[victim].store(data, std::memory_order_relaxed);
+    stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+TTStats TranspositionTable::stats() const {
+    TTStats s;
+    s.hits = hits.load();
+    s.misses = misses.load();
+    s.collisions = collisions.load();
+    s.stores = stores.load();
+    s.evictions = evictions.load();
+    return s;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum TTBound { TT_NONE = 0, TT_LOWER = 1, TT_EXACT = 2 };
+
+struct TTEntry {
+    int distance;       // distance to goal (exact) or a lower bound on it
+    int depth;          // effort behind the entry; deeper entries survive replacement
+    TTBound bound;
+};
+
+struct TTStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t collisions;    // misses where every entry of the bucket held another state
+    uint64_t stores;
+    uint64_t evictions;     // stores that overwrote a different state
+};
+
+// Fixed-size table keyed by 64-bit Zobrist hash, shared by any number of
+// threads without locks. Each 64-byte bucket holds four entries stored as
+// (hash ^ data, data) pairs: a torn write fails the XOR check and reads as a
+// miss instead of returning another state's data.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes);
+
+    bool probe(uint64_t hash, TTEntry& entry);
+    void store(uint64_t hash, int distance, int depth, TTBound bound);
+
+    // Marks a new search; older entries are replaced first
+    void newGeneration() { generation.fetch_add(1, std::memory_order_relaxed); }
+    void clear();
+
+    TTStats stats() const;
+    size_t bytes() const { return bucketCount * sizeof(Bucket); }
+    size_t capacity() const { return bucketCount * ENTRIES_PER_BUCKET; }
+
+private:
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> check[ENTRIES_PER_BUCKET];
+        std::atomic<uint64_t> data[ENTRIES_PER_BUCKET];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount;
+    std::atomic<uint32_t> generation;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> collisions;
+    std::atomic<uint64_t> stores;
+    std::atomic<uint64_t> evictions;
+};
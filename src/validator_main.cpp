@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level_pack.h"
+#include "level_validator.h"
+#include "levels.h"
+#include "process_stats.h"
+
+// Checks level packs and level files without the game:
+//   ParkingJamValidator [--threads N] [--max-states N] [--no-solve] [--json FILE] [--all]
+//                       [PACK.pjlp | level.lvl ...]
+// With no inputs the built-in levels are checked. Levels are spread over the
+// threads; the exit code is 1 if any level is invalid, unsolvable or unreadable.
+// The JSON report lists every level that is not "ok" (every level with --all).
+
+struct LevelInput {
+    std::string path;
+    std::unique_ptr<LevelPack> pack;    // NULL for a .lvl file or the built-in levels
+    int levelCount;
+};
+
+struct LevelRef {
+    int input;
+    int number;             // 1-based within its input
+};
+
+struct LevelOutcome {
+    bool loaded = false;
+    LevelValidation validation;
+
+    const char* status() const { return loaded ? validation.status() : "unreadable"; }
+};
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool loadInputLevel(const LevelInput& input, int number, LevelSetup& level) {
+    if (input.pack) return input.pack->load(number - 1, level);
+    if (input.path.empty()) return setupBuiltinLevel(number, level);
+    return loadLevelFile(input.path, level);
+}
+
+static std::string inputName(const LevelInput& input) {
+    return input.path.empty() ? "builtin" : input.path;
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static const char* const STATUSES[] = {"ok", "invalid", "unsolvable", "unknown", "unreadable"};
+static const char* const CHECKS[] = {CHECK_OVERLAP, CHECK_BOUNDS, CHECK_LANE, CHECK_TARGET, CHECK_FLOOR,
+                                     CHECK_SOLVABLE};
+
+static bool writeJsonReport(const std::string& path, const ValidatorOptions& options, int threadCount,
+                            double seconds, bool listAll, const std::vector<LevelInput>& inputs,
+                            const std::vector<LevelRef>& levels, const std::vector<LevelOutcome>& outcomes) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Validator: cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"levels\": " << levels.size() << ",\n";
+    out << "  \"threads\": " << threadCount << ",\n";
+    out << "  \"solve\": " << (options.solve ? "true" : "false") << ",\n";
+    out << "  \"max_states\": " << options.maxStates << ",\n";
+    out << "  \"seconds\": " << seconds << ",\n";
+    out << "  \"status_counts\": {";
+    for (size_t s = 0; s < sizeof(STATUSES) / sizeof(STATUSES[0]); s++) {
+        size_t count = std::count_if(outcomes.begin(), outcomes.end(), [s](const LevelOutcome& outcome) {
+            return std::strcmp(outcome.status(), STATUSES[s]) == 0;
+        });
+        out << (s > 0 ? ", " : "") << jsonString(STATUSES[s]) << ": " << count;
+    }
+    out << "},\n";
+    // Levels failing each check, however many times they fail it
+    out << "  \"check_counts\": {";
+    for (size_t c = 0; c < sizeof(CHECKS) / sizeof(CHECKS[0]); c++) {
+        size_t count = std::count_if(outcomes.begin(), outcomes.end(), [c](const LevelOutcome& outcome) {
+            const std::vector<LevelIssue>& issues = outcome.validation.issues;
+            return std::any_of(issues.begin(), issues.end(), [c](const LevelIssue& issue) {
+                return std::strcmp(issue.check, CHECKS[c]) == 0;
+            });
+        });
+        out << (c > 0 ? ", " : "") << jsonString(CHECKS[c]) << ": " << count;
+    }
+    out << "},\n";
+    out << "  \"results\": [";
+    bool first = true;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const LevelOutcome& outcome = outcomes[i];
+        if (!listAll && std::strcmp(outcome.status(), "ok") == 0) continue;
+        const LevelValidation& validation = outcome.validation;
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "    {\"input\": " << jsonString(inputName(inputs[levels[i].input])) << ", \"level\": "
+            << levels[i].number << ", \"status\": \"" << outcome.status() << "\"";
+        if (validation.solved) out << ", \"moves\": " << validation.moves;
+        if (validation.searched) out << ", \"states\": " << validation.states;
+        out << ", \"issues\": [";
+        for (size_t k = 0; k < validation.issues.size(); k++) {
+            const LevelIssue& issue = validation.issues[k];
+            out << (k > 0 ? ", " : "") << "{\"check\": \"" << issue.check << "\", \"car\": " << issue.car
+                << ", \"message\": " << jsonString(issue.message) << "}";
+        }
+        out << "]}";
+    }
+    out << (first ? "]\n" : "\n  ]\n");
+    out << "}\n";
+    out.close();
+    if (!out) {
+        std::cerr << "Validator: error writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    ValidatorOptions options;
+    int threadCount = 0;
+    bool listAll = false;
+    const char* jsonPath = NULL;
+    std::vector<LevelInput> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], NULL, 10);
+        } else if (std::strcmp(argv[i], "--no-solve") == 0) {
+            options.solve = false;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--all") == 0) {
+            listAll = true;
+        } else if (argv[i][0] != '-') {
+            LevelInput input;
+            input.path = argv[i];
+            input.levelCount = 1;
+            if (endsWith(input.path, ".pjlp")) {
+                input.pack.reset(new LevelPack());
+                if (!input.pack->open(input.path)) return 1;
+                input.levelCount = input.pack->size();
+            }
+            inputs.push_back(std::move(input));
+        } else {
+            std::cerr << "Usage: ParkingJamValidator [--threads N] [--max-states N] [--no-solve] [--json FILE] "
+                         "[--all] [PACK.pjlp | level.lvl ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        LevelInput builtin;
+        builtin.levelCount = BUILTIN_LEVEL_COUNT;
+        inputs.push_back(std::move(builtin));
+    }
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+
+    std::vector<LevelRef> levels;
+    for (size_t n = 0; n < inputs.size(); n++) {
+        for (int number = 1; number <= inputs[n].levelCount; number++) levels.push_back({(int)n, number});
+    }
+
+    // Workers claim small batches so a few slow searches do not leave threads idle
+    const size_t BATCH = 64;
+    std::vector<LevelOutcome> outcomes(levels.size());
+    std::atomic<size_t> nextLevel(0);
+    double startTime = monotonicSeconds();
+    auto work = [&]() {
+        LevelSetup level;
+        while (true) {
+            size_t first = nextLevel.fetch_add(BATCH);
+            if (first >= levels.size()) break;
+            size_t last = std::min(levels.size(), first + BATCH);
+            for (size_t i = first; i < last; i++) {
+                LevelOutcome& outcome = outcomes[i];
+                outcome.loaded = loadInputLevel(inputs[levels[i].input], levels[i].number, level);
+                if (outcome.loaded) validateLevel(level, options, outcome.validation);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++) threads.emplace_back(work);
+    work();
+    for (auto& thread : threads) thread.join();
+    double seconds = monotonicSeconds() - startTime;
+
+    // The first few problems in readable form; the report has all of them
+    const int SHOWN_PROBLEMS = 20;
+    int failures = 0;
+    int unknown = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const LevelOutcome& outcome = outcomes[i];
+        const char* status = outcome.status();
+        if (std::strcmp(status, "ok") == 0) continue;
+        if (std::strcmp(status, "unknown") == 0) {
+            unknown++;
+            continue;
+        }
+        if (failures++ >= SHOWN_PROBLEMS) continue;
+        std::cout << inputName(inputs[levels[i].input]) << " level " << levels[i].number << ": " << status;
+        for (const LevelIssue& issue : outcome.validation.issues) std::cout << "; " << issue.message;
+        std::cout << std::endl;
+    }
+    if (failures > SHOWN_PROBLEMS) std::cout << "... and " << failures - SHOWN_PROBLEMS << " more" << std::endl;
+
+    std::cout << levels.size() << " levels: " << levels.size() - failures - unknown << " ok, " << failures
+              << " failed, " << unknown << " unknown (past " << options.maxStates << " states or too big to search)"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "  " << seconds << " s on " << threadCount << " threads";
+    if (seconds > 0.0) std::cout << std::setprecision(0) << ", " << levels.size() / seconds << " levels per second";
+    std::cout << std::endl;
+
+    if (jsonPath) {
+        if (!writeJsonReport(jsonPath, options, threadCount, seconds, listAll, inputs, levels, outcomes)) return 1;
+        std::cout << "Wrote " << jsonPath << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}